@@ -5,14 +5,19 @@ class AreaLight
 {
 	public:
 		AreaLight( Triangle* triangle, emissiveMaterial* em )
-			: _triangle(triangle), _ematerial(em),
+			: _triangle(triangle), _ematerial(em), _index(0),
 			  _area( 0.5f * (math::vec::crossProduct(triangle->edge1(), triangle->edge2()).length()) )
 		{ }
 
-		const vector3 getSample()
+		/// Point of the patch
+		/**
+			@param u1[in] uniform random number in [0, 1]
+			@param u2[in] uniform random number in [0, 1]
+		*/
+		const vector3 getSample( float u1, float u2 ) const
 		{
-			float b0 = static_cast<float>(rand()) / static_cast<float>(RAND_MAX),
-				  b1 = ( 1.0f - b0 ) * float(rand()) / static_cast<float>(RAND_MAX),
+			float b0 = u1,
+				  b1 = ( 1.0f - b0 ) * u2,
 				  b2 = 1.0f - b0 - b1;
 
 			return b0 * _triangle->a() + 
@@ -20,6 +25,25 @@ class AreaLight
 				   b2 * _triangle->c();
 		}
 
+		/// Fixed points of the patch the shadow maps are rendered from
+		/**
+			The first one is the centroid, the others lie halfway between the centroid and the vertices.
+
+			@param sample[in] index below AREA_SHADOW_SAMPLES
+		*/
+		vector3 getShadowSample( uint32 sample ) const
+		{
+			const vector3 centroid = ( _triangle->a() + _triangle->b() + _triangle->c() ) * ( 1.0f / 3.0f );
+
+			switch ( sample )
+			{
+				case 1: return 0.5f * ( centroid + _triangle->a() );
+				case 2: return 0.5f * ( centroid + _triangle->b() );
+				case 3: return 0.5f * ( centroid + _triangle->c() );
+				default: return centroid;
+			}
+		}
+
 		float getArea() const
 		{ return _area; }
 
@@ -36,12 +60,30 @@ class AreaLight
 		rgb getColor() const
 		{ return _ematerial->color(); }
 
+		emissiveMaterial const& getEmissiveMaterial() const
+		{ return *_ematerial; }
+
+		/// Replaces the emission, materials may be shared by more lights so they are never modified
+		void setEmissiveMaterial( emissiveMaterial* em )
+		{ 
+			_ematerial = em;
+			_triangle->setEmissiveMaterial( em );
+		}
+
 		Triangle* getTriangle()
 		{ return _triangle; }
 
+		/// Index of the light among the area lights, assigned by RayTracer::addAreaLight
+		void setIndex( uint32 index )
+		{ _index = index; }
+
+		uint32 getIndex() const
+		{ return _index; }
+
 	private:			
 		Triangle*	_triangle;
 		emissiveMaterial* _ematerial;
+		uint32		_index;
 
 		float		_area;
 
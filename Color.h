@@ -21,12 +21,18 @@ struct rgb
 		float green() const { return _g; }
 		float blue() const { return _b; }
 
+		/// Perceived brightness of the color (Rec. 709 weights)
+		float luminance() const { return 0.2126f * _r + 0.7152f * _g + 0.0722f * _b; }
+
 		rgb operator* ( rgb const& color )
 		{ return rgb(_r * color.red(), _g * color.green(), _b * color.blue()); }
 
 		rgb operator+ ( rgb const& color )
 		{ return rgb(_r + color.red(), _g + color.green(), _b + color.blue()); }
 
+		rgb operator- ( rgb const& color )
+		{ return rgb(_r - color.red(), _g - color.green(), _b - color.blue()); }
+
 		rgb& operator+= ( rgb const& color )
 		{ _r += color.red(); _g += color.green(); _b += color.blue(); return (*this); }
 
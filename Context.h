@@ -13,6 +13,18 @@
 #include "PointLight.h"
 #include "Primitive.h"
 #include "AreaLight.h"
+#include "IrradianceCache.h"
+#include "Lightmap.h"
+#include "RayGenerator.h"
+#include "ShadingPacket.h"
+#include "Denoiser.h"
+#include "TemporalHistory.h"
+#include "RelightCache.h"
+#include "FrameCache.h"
+#include "DirtyRegion.h"
+#include "ShadowMap.h"
+#include "Frustum.h"
+#include "Scene.h"
 #include "RayTracer.h"
 
 /// A context class.
@@ -33,7 +45,12 @@ class Context
 		*/
 		Context ( uint32 width = 0, uint32 height = 0 ) 
 			: _w(width), _h(height), _size(width*height), _inCycle(false), _updateMVPMneeded(false),
-			_currentEmissiveMaterial(NULL)
+			_isDefiningScene(false), _currentEmissiveMaterial(NULL), _shareShadows(false), _conservativeShadows(false), _denoise(false),
+			_dynamicResolution(false), _frameTimeTarget(0.0f), _lastFrameTime(0.0f), _resolutionScale(1.0f), _tracedPixels(0),
+			_temporalReuse(false), _reusedPixels(0), _relightCache(false),
+			_frameCache(false), _frameCacheHit(false), _regionPixels(0), _idBuffer(NULL), _fillPrimitive(NO_PRIMITIVE),
+			_culledClusters(0), _culledPrimitives(0), _hybrid(false), _rasterizedPixels(0), _shadowMapping(false), _shadowMapsRendered(0),
+			_previewStride(0)
 		{ 
 			_matrixStack		= new std::vector<matrix4x4>;
 			_colorBuffer		= new rgb[width * height];
@@ -49,7 +66,8 @@ class Context
 		/**
 			Called when deleting a context. Frees all used memory.
 		*/
-		~Context(){ };
+		~Context()
+		{ delete _rayTracer; }
 
 		/// Returns pointer to the color buffer.
 		/**
@@ -455,10 +473,25 @@ class Context
 			int32 to = static_cast<int32>( x_b );
 
 			if (from > to)
+			{
 				std::swap(from, to);			
+				std::swap(d_a, d_b);
+			}
+
+			if ( y < 0 || y >= static_cast<int32>( _h ) )
+				return;
 			
 			float step = (d_b - d_a) / static_cast<float>(to - from);
-			for (uint32 x = from; x <= to; ++x, d_a += step)
+
+			// clip the span to the buffer
+			if ( from < 0 )
+			{
+				d_a -= step * from;
+				from = 0;
+			}
+			to = std::min( to, static_cast<int32>( _w ) - 1 );
+
+			for (int32 x = from; x <= to; ++x, d_a += step)
 				setPixel(x, y, d_a, true);
 		}
 
@@ -478,7 +511,13 @@ class Context
 			if (from > to)
 				std::swap(from, to);			
 
-			for (uint32 x = from; x < to; ++x)
+			if ( y < 0 || y >= static_cast<int32>( _h ) )
+				return;
+
+			from = std::max( from, 0 );
+			to = std::min( to, static_cast<int32>( _w ) );
+
+			for (int32 x = from; x < to; ++x)
 				setPixel(x, y);
 		}
 
@@ -619,6 +658,10 @@ class Context
 		*/
 		void			setPixel(uint32 x, uint32 y, float z = 0.0f, bool depth = false)
 		{
+			// negative coordinates wrap around
+			if ( x >= _w || y >= _h )
+				return;
+
 			if (depth)
 			{
 				uint32 pos = _w * y + x;
@@ -626,7 +669,12 @@ class Context
 				if (z <= _zbuffer[pos])
 				{
 					_zbuffer[pos] = z;
-					setColorBuffer(x, y, _currentColor);
+
+					// the visibility pass writes primitives instead of colors
+					if ( _idBuffer )
+						_idBuffer[pos] = _fillPrimitive;
+					else
+						setColorBuffer(x, y, _currentColor);
 				}
 			}
 			else
@@ -741,6 +789,13 @@ class Context
 		void setSceneDefining( bool value )
 		{ _isDefiningScene = value; }		
 
+		/// Finishes the scene definition and prepares the scene for rendering
+		void endScene()
+		{
+			_isDefiningScene = false;
+			_rayTracer->prepareScene();
+		}
+
 		void setCurrentMaterial( float const& r, float const& g, float const& b, float const& kd,  float const& ks, float const& shine, float const& T, float const& ior )
 		{ setCurrentMaterial( material( rgb(r, g, b), kd, ks, shine, T, ior ) ); }
 
@@ -772,6 +827,11 @@ class Context
 			triangle->setMaterial( _currentMaterial );		
 
 			_rayTracer->addPrimitive( triangle );
+
+			_rayTracer->getSceneHash().add( _vectorBuffer[0] );
+			_rayTracer->getSceneHash().add( _vectorBuffer[1] );
+			_rayTracer->getSceneHash().add( _vectorBuffer[2] );
+			_rayTracer->getSceneHash().add( _currentMaterial );
 		}	
 
 		void addSphere( vector3 const& center, float const& radius )
@@ -782,107 +842,1754 @@ class Context
 			sphere->setMaterial( _currentMaterial );
 
 			_rayTracer->addPrimitive( sphere );
+
+			_rayTracer->getSceneHash().add( center );
+			_rayTracer->getSceneHash().add( radius );
+			_rayTracer->getSceneHash().add( _currentMaterial );
 		}
 
 		void renderScene()
 		{
-			doMVPMupdate();
+			const double start = wallClock();
 
-			_rayTracer->setInverseMatrix( _matrix[M_MVP].inverse() );
-			_rayTracer->setViewportMatrix( _viewport, _matrix[M_VIEWPORT] );
+			beginRender();
+
+			// the new image is the base sglRayTraceDirty updates
+			_dirty.reset( _w, _h, _matrix[M_MVP], _rayTracer->getSceneVersion() );
+			_regionPixels = _size;
+
+			if ( _dynamicResolution )
+			{
+				renderSceneScaled();
+				_lastFrameTime = static_cast<float>( ( wallClock() - start ) * 1000.0 );
+				return;
+			}
+
+			if ( _temporalReuse )
+			{
+				renderSceneTemporal();
+				return;
+			}
+
+			// a recent image of the same scene, camera and settings
+			const uint64 key = _frameCache ? frameKey() : 0;
+
+			_frameCacheHit = _frameCache && _frames.find( key, _colorBuffer, _size );
+			if ( _frameCacheHit )
+			{
+				_regionPixels = 0;
+				_lastFrameTime = static_cast<float>( ( wallClock() - start ) * 1000.0 );
+				return;
+			}
+
+			if ( _relightCache && !_rayTracer->samplesLights() )
+			{
+				renderSceneRecorded();
+			}
+			else
+			{
+				// the denoiser needs the surfaces seen through the pixels
+				surfaceSample* surfaces = NULL;
+				if ( _denoise )
+				{
+					_surfaces.resize( _size );
+					surfaces = &_surfaces[0];
+				}
+
+				if ( _hybrid )
+					renderSceneHybrid( surfaces );
+				else if ( _shareShadows && _rayTracer->getLightCount() )
+					renderSceneSharedShadows( surfaces );
+				else
+					renderScenePackets( surfaces );
+
+				if ( _denoise )
+					_denoiser.denoise( _colorBuffer, surfaces, _w, _h );
+			}
+
+			if ( _frameCache )
+				_frames.insert( key, _colorBuffer, _size );
+
+			_lastFrameTime = static_cast<float>( ( wallClock() - start ) * 1000.0 );
+		}
+
+		/// Hash of everything an image of renderScene depends on
+		/**
+			The geometry is hashed as it's added, see Scene::hash. Lights can be edited, so they are hashed here
+			along with the camera and the render settings, an edit which is undone gives the old key again.
+		*/
+		uint64 frameKey() const
+		{
+			ContentHash hash = _rayTracer->getSceneHash();
+
+			hash.add( _w );
+			hash.add( _h );
+			hash.add( _matrix[M_MVP] );
+			hash.add( _matrix[M_VIEWPORT] );
+
+			hash.add( static_cast<uint32>( _shareShadows ) | static_cast<uint32>( _conservativeShadows ) << 1 | static_cast<uint32>( _denoise ) << 2 | static_cast<uint32>( _hybrid ) << 3 );
+
+			_rayTracer->hashState( hash );
+
+			return hash.value();
+		}
+
+		/// Enables/disables reuse of recently rendered images, see renderScene
+		void enableFrameCache( bool value )
+		{ 
+			_frameCache = value; 
+			_frames.clear();
+		}
+
+		/// Renders the scene reusing the shaded pixels of the previous frame
+		/**
+			The previous frame is reprojected to the new camera, see TemporalHistory. Every pixel traces its primary
+			ray and takes the reprojected color when it sees the same primitive at (nearly) the same world position
+			and the sample isn't older than TEMPORAL_MAX_AGE frames. Only the other pixels (disocclusions, moving
+			edges, expired samples) are shaded. View dependent light (highlights, reflections) lags behind for at
+			most TEMPORAL_MAX_AGE frames.
+
+			The history is dropped whenever the scene or its lights change.
+		*/
+		void renderSceneTemporal()
+		{
+			const uint32 sceneVersion = _rayTracer->getSceneVersion();
+
+			const bool filled = _history.isValid( _w, _h, sceneVersion );
+
+			if ( filled )
+				_history.reproject( _matrix[M_MVP], _viewport );
+			else
+				_history.reset( _w, _h, sceneVersion );
+
+			_reusedPixels = 0;
 
 			for ( uint32 y = 0; y < _h; ++y )
 			{
-				for ( uint32 x = 0; x < _w; ++x )		
-				{					
-					setColorBuffer( x, y, _rayTracer->castRay(x, y) );				
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					Ray ray = _rayTracer->generateRay( x, y );
+					HitInfo hitInfo;
+
+					_rayTracer->findClosestHit( &ray, &hitInfo );
+
+					Primitive* primitive = hitInfo.getPrimitive();
+					const vector3 hitPoint = ray.getOrigin() + ( ray.getDirection() * hitInfo.getDistance() );
+
+					historySample sample = _history.reprojected( x, y );
+
+					if ( primitive && sample.primitiveId == primitive->getId() && sample.age + 1 < TEMPORAL_MAX_AGE &&
+						 ( sample.position - hitPoint ).length() < TEMPORAL_POSITION_TOLERANCE * hitInfo.getDistance() )
+					{
+						++sample.age;
+						++_reusedPixels;
+					}
+					else
+					{
+						sample.color		= _rayTracer->shadeClosestHit( &ray, &hitInfo );
+						sample.position		= hitPoint;
+						sample.primitiveId	= primitive ? primitive->getId() : NO_PRIMITIVE;
+						// the first frame staggers the ages, so that the pixels don't all expire in the same frame
+						sample.age			= filled ? 0 : ( x * 7 + y * 13 ) % TEMPORAL_MAX_AGE;
+					}
+
+					setColorBuffer( x, y, sample.color );
+					_history.store( x, y, sample );
 				}
 			}
 		}
 
-		void setCurrentEmissiveMaterial( float r, float g, float b, float c0, float c1, float c2 )
+		/// Renders the scene and records the hits of every pixel for relightScene
+		void renderSceneRecorded()
 		{
-			_currentEmissiveMaterial = new emissiveMaterial( rgb( r, g, b ), c0, c1, c2 );
+			_relight.begin( _w, _h, _matrix[M_MVP] );
+			_rayTracer->recordPaths( &_relight.nodes() );
+
+			for ( uint32 y = 0; y < _h; ++y )
+			{
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					setColorBuffer( x, y, _rayTracer->castRay( x, y ) );
+					_relight.endPixel();
+				}
+			}
+
+			_rayTracer->recordPaths( NULL );
+			_relight.end( _rayTracer->getSceneVersion() );
 		}
 
-		emissiveMaterial* getCurrentEmissiveMaterial()
+		/// Renders the scene after light edits, reusing the hits of the last render
+		/**
+			Only the light of the recorded hits is evaluated again, no primary or secondary rays are cast. A hit
+			pays one shadow ray per edited point light which kept its position (two when it moved), and the area
+			light samples only when an area light was edited. Falls back to renderScene when the camera, the
+			viewport or the geometry changed since the last recorded render.
+		*/
+		void relightScene()
 		{
-			return _currentEmissiveMaterial;
+			beginRender();
+
+			if ( !_relightCache || _rayTracer->samplesLights() || !_relight.isValid( _w, _h, _matrix[M_MVP], _rayTracer->getSceneVersion() ) )
+			{
+				renderScene();
+				return;
+			}
+
+			std::vector<pathNode>& nodes = _relight.nodes();
+
+			for ( uint32 y = 0; y < _h; ++y )
+			{
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					const uint32 pixel = _w * y + x;
+					rgb color;
+
+					for ( uint32 i = _relight.firstNode( pixel ); i < _relight.lastNode( pixel ); ++i )
+						color += _rayTracer->relightPathNode( nodes[i], _relight.getPointLightEdits(), _relight.areaLightsEdited() ) * nodes[i].weight;
+
+					setColorBuffer( x, y, color );
+				}
+			}
+
+			_relight.clearEdits();
+			_dirty.reset( _w, _h, _matrix[M_MVP], _rayTracer->getSceneVersion() );
 		}
 
-		void addAreaLight()
+		/// Renders a rectangle of the image, the rest of the color buffer is kept
+		/**
+			@param x[in] X coord of the bottom left corner
+			@param y[in] Y coord of the bottom left corner
+			@param w[in] width, clipped to the image
+			@param h[in] height, clipped to the image
+		*/
+		void renderRegion( uint32 x, uint32 y, uint32 w, uint32 h )
 		{
-			Triangle* triangle = new Triangle(
-						_vectorBuffer[0],
-						_vectorBuffer[1],
-						_vectorBuffer[2]
-					);
-					
-			AreaLight* light = new AreaLight(triangle, _currentEmissiveMaterial);
+			beginRender();
 
-			_rayTracer->addAreaLight(light);			
+			_regionPixels = 0;
+
+			if ( x >= _w || y >= _h )
+				return;
+
+			w = std::min( w, _w - x );
+			h = std::min( h, _h - y );
+
+			renderRegionPackets( x, y, w, h, NULL );
+			_regionPixels = w * h;
 		}
 
-		void setBg( float width, float height, float* bg )
+		/// Ray traces the scene of this context from several cameras at once
+		/**
+			The views share the prepared scene, its clusters, material classes and lightmaps, and their tiles
+			are traced by one pool of threads, so small views keep all the threads busy. Every view is
+			rendered into the color buffer of its target with the target's viewport. The matrices of the
+			targets aren't changed, their dirty regions and previews start over. The tiles are traced in
+			parallel unless the ray tracer modifies shared state while shading, see RayTracer::isThreadSafe.
+			Every tile seeds the random numbers of its thread, so the images don't depend on the schedule.
+
+			@param mvps[in] model-view-projection matrix of every view
+			@param count[in] number of views
+			@param targets[in] distinct context of every view, may include this one
+		*/
+		void renderViews( const matrix4x4* mvps, uint32 count, Context* const* targets )
 		{
-			_rayTracer->setEmBackground( width, height, bg );
+			beginRender();
+
+			std::vector<RayGenerator> generators( count );
+			std::vector<viewTile> tiles;
+
+			for ( uint32 v = 0; v < count; ++v )
+			{
+				Context* target = targets[v];
+				generators[v].setup( mvps[v].inverse(), target->_viewport );
+
+				for ( uint32 y = 0; y < target->_h; y += VIEW_TILE_SIZE )
+					for ( uint32 x = 0; x < target->_w; x += VIEW_TILE_SIZE )
+						tiles.push_back( viewTile( v, x, y ) );
+			}
+
+#ifdef _OPENMP
+			const bool parallel = _rayTracer->isThreadSafe();
+
+			#pragma omp parallel for schedule(dynamic) if( parallel )
+#endif
+			for ( int32 t = 0; t < static_cast<int32>( tiles.size() ); ++t )
+			{
+				const viewTile& tile = tiles[t];
+				Context* target = targets[tile.view];
+
+				_rayTracer->seedRandom( t );
+
+				const uint32 w = std::min( VIEW_TILE_SIZE, target->_w - tile.x );
+				const uint32 h = std::min( VIEW_TILE_SIZE, target->_h - tile.y );
+
+				rayPacket packet;
+				rgb colors[RAY_PACKET_SIZE];
+
+				for ( uint32 y = tile.y; y < tile.y + h; ++y )
+				{
+					for ( uint32 x = tile.x; x < tile.x + w; x += RAY_PACKET_SIZE )
+					{
+						const uint32 packetSize = std::min( RAY_PACKET_SIZE, tile.x + w - x );
+
+						generators[tile.view].generatePacket( x, y, packet );
+						_rayTracer->castPacket( packet, packetSize, colors );
+
+						for ( uint32 i = 0; i < packetSize; ++i )
+							target->setColorBuffer( x + i, y, colors[i] );
+					}
+				}
+			}
+
+			_regionPixels = 0;
+
+			for ( uint32 v = 0; v < count; ++v )
+			{
+				targets[v]->_dirty.invalidate();
+				targets[v]->resetPreview();
+				_regionPixels += targets[v]->_size;
+			}
 		}
 
-	protected:
-		void doMVPMupdate()
+		/// Re-traces the tiles light edits changed since the last render
+		/**
+			An edited light can only change the primitives it can light (before or after the edit), the
+			reflective and transmissive ones and its own patch, see markLitPrimitives. The tiles covered by their
+			projected bounds are traced again. Falls back to renderScene when the camera, the viewport or the
+			geometry changed.
+		*/
+		void renderSceneDirty()
 		{
-			_matrix[M_MVP] =  _matrix[M_PROJECTION] * _matrix[M_MODELVIEW];
+			beginRender();
 
-			_updateMVPMneeded = false;
+			if ( !_dirty.isValid( _w, _h, _matrix[M_MVP], _rayTracer->getSceneVersion() ) )
+			{
+				renderScene();
+				return;
+			}
+
+			_regionPixels = 0;
+
+			for ( uint32 ty = 0; ty < _dirty.getTilesY(); ++ty )
+			{
+				for ( uint32 tx = 0; tx < _dirty.getTilesX(); ++tx )
+				{
+					if ( !_dirty.isDirty( tx, ty ) )
+						continue;
+
+					const uint32 x = tx * DIRTY_TILE_SIZE;
+					const uint32 y = ty * DIRTY_TILE_SIZE;
+					const uint32 w = std::min( DIRTY_TILE_SIZE, _w - x );
+					const uint32 h = std::min( DIRTY_TILE_SIZE, _h - y );
+
+					renderRegionPackets( x, y, w, h, NULL );
+					_regionPixels += w * h;
+				}
+			}
+
+			_dirty.reset( _w, _h, _matrix[M_MVP], _rayTracer->getSceneVersion() );
 		}
 
-		void initZBuffer()
-		{			
-			_zbuffer = new float[_w * _h];
-			clearZBuffer();
+		/// Marks the tiles a light edit can change, see renderSceneDirty
+		/**
+			@param points[in] light positions before and after the edit, or the corners of an area light
+			@param count[in] number of points
+			@param patch[in] area light patch, NULL for point lights
+		*/
+		void markLitPrimitives( const vector3* points, uint32 count, Primitive* patch )
+		{
+			std::vector<Primitive*> primitives;
+			_rayTracer->findLitPrimitives( points, count, primitives );
+
+			if ( patch )
+				primitives.push_back( patch );
+
+			for ( std::vector<Primitive*>::const_iterator it = primitives.begin(); it != primitives.end(); ++it )
+			{
+				uint32 x0, y0, x1, y1;
+
+				// the bounds are widened by a pixel, a pixel covers its ray and half of the way to its neighbours
+				if ( projectBounds( *it, x0, y0, x1, y1 ) )
+					_dirty.mark( x0 - 1.0f, y0 - 1.0f, x1 + 1.0f, y1 + 1.0f );
+			}
 		}
 
-	
+		/// Moves/recolors a point light, see relightScene
+		/**
+			@param index[in] index of the light in the order the lights were added
+			@param position[in] new position
+			@param color[in] new color
+		*/
+		void setPointLight( uint32 index, vector3 const& position, rgb const& color )
+		{
+			const bool cached	= _relight.isValid( _rayTracer->getSceneVersion() );
+			const bool tracked	= isTrackingDirty();
 
-	private:
-		uint32 _w, _h;
-		uint32 _size;
-		
-		rgb*				_colorBuffer;
-		float*					_zbuffer;
+			const vector3 points[2] = { _rayTracer->getLight( index ).getPosition(), position };
 
-		float					_pointSize;
+			if ( cached )
+				_relight.editPointLight( index, _rayTracer->getLight( index ) );
 
-		rgb				_currentColor;
-		rgb				_clearColor;
+			_rayTracer->setLight( index, position, color );
 
-		std::vector<vertex>		_vertexBuffer;
-		std::vector<vector3>	_vectorBuffer;
-		std::vector<matrix4x4>*	_matrixStack;
-		std::vector<uint32>		_edgeBuffer;
-		
-		viewport				_viewport;
-		
-		matrix4x4				_matrix[M_SIZE];
+			if ( cached )
+				_relight.update( _rayTracer->getSceneVersion() );
 
-		sglEMatrixMode			_currentMatrixMode;
-		sglEAreaMode			_currentAreaMode;
-		sglEElementType			_drawingMode;
+			if ( tracked )
+			{
+				markLitPrimitives( points, 2, NULL );
+				_dirty.update( _rayTracer->getSceneVersion() );
+			}
+		}
 
-		bool					_inCycle;
-		bool					_depthTest;
-		bool					_updateMVPMneeded;
+		/// Replaces the emission of an area light, see relightScene
+		/**
+			@param index[in] index of the area light in the order the lights were added
+		*/
+		void setAreaLightEmission( uint32 index, float r, float g, float b, float c0, float c1, float c2 )
+		{
+			const bool cached	= _relight.isValid( _rayTracer->getSceneVersion() );
+			const bool tracked	= isTrackingDirty();
 
-		std::vector<edge>		_nonActiveEdges;
-		std::vector<edge>		_edgeBeginnings;
-		std::vector<edge>		_edgesEnds;
-		std::vector<edge>		_activeEdges;
+			_rayTracer->setAreaLightEmission( index, new emissiveMaterial( rgb( r, g, b ), c0, c1, c2 ) );
 
-		// RayTracer
-		bool					_isDefiningScene;
-		RayTracer*				_rayTracer;
-		material				_currentMaterial;
-		emissiveMaterial*		_currentEmissiveMaterial;
+			if ( cached )
+			{
+				_relight.editAreaLight();
+				_relight.update( _rayTracer->getSceneVersion() );
+			}
+
+			if ( tracked )
+			{
+				Triangle* patch = _rayTracer->getAreaLightTriangle( index );
+				const vector3 points[3] = { patch->a(), patch->b(), patch->c() };
+
+				markLitPrimitives( points, 3, patch );
+				_dirty.update( _rayTracer->getSceneVersion() );
+			}
+		}
+
+		/// Checks whether light edits can be tracked as dirty tiles of the last image
+		bool isTrackingDirty()
+		{
+			doMVPMupdate();
+			return _dirty.isValid( _w, _h, _matrix[M_MVP], _rayTracer->getSceneVersion() );
+		}
+
+		uint32 getLightCount() const
+		{ return _rayTracer->getLightCount(); }
+
+		uint32 getAreaLightCount() const
+		{ return _rayTracer->getAreaLightCount(); }
+
+		/// Enables/disables recording of the hits for relightScene
+		void enableRelightCache( bool value )
+		{ 
+			_relightCache = value; 
+			_relight.invalidate();
+		}
+
+		/// Enables/disables the reuse of the previous frame, see renderSceneTemporal
+		void enableTemporalReuse( bool value )
+		{ 
+			_temporalReuse = value; 
+			_history.reset( 0, 0, 0 );
+		}
+
+		/// Renders the scene at a reduced resolution and upscales it
+		/**
+			The resolution scale follows the time of the previous frame, the shaded pixel count is proportional
+			to its square. The scaled image is shaded with full quality, then a primary ray of every full
+			resolution pixel finds the visible primitive. A pixel blends the nearest scaled samples which see
+			the same primitive (bilinear weights), so the upscaled image doesn't bleed across object edges.
+			Pixels without such a sample (thin or small objects) are traced at full resolution.
+		*/
+		void renderSceneScaled()
+		{
+			// pick the scale for this frame
+			if ( _lastFrameTime > 0.0f && _frameTimeTarget > 0.0f )
+			{
+				const float ratio = std::min( std::max( _frameTimeTarget / _lastFrameTime, 0.25f ), 4.0f );
+				_resolutionScale = std::min( std::max( _resolutionScale * sqrtf( ratio ), DYNAMIC_RESOLUTION_MIN_SCALE ), 1.0f );
+			}
+
+			_tracedPixels = 0;
+
+			const uint32 w = std::max( static_cast<uint32>( _w * _resolutionScale + 0.5f ), 1u );
+			const uint32 h = std::max( static_cast<uint32>( _h * _resolutionScale + 0.5f ), 1u );
+
+			// full resolution needs no upscaling
+			if ( w == _w && h == _h )
+			{
+				renderScenePackets( NULL );
+				return;
+			}
+
+			// sample [i, j] lies in the center of its footprint in full resolution pixels
+			const float stepX = static_cast<float>( _w ) / w;
+			const float stepY = static_cast<float>( _h ) / h;
+
+			_scaledColors.resize( w * h );
+			_scaledIds.resize( w * h );
+
+			for ( uint32 j = 0; j < h; ++j )
+			{
+				for ( uint32 i = 0; i < w; ++i )
+				{
+					Ray ray = _rayTracer->generateSubpixelRay( ( i + 0.5f ) * stepX - 0.5f, ( j + 0.5f ) * stepY - 0.5f );
+					surfaceSample surface;
+
+					_scaledColors[j * w + i]	= _rayTracer->castRay( &ray, &surface );
+					_scaledIds[j * w + i]		= surface.primitiveId;
+				}
+			}
+
+			for ( uint32 y = 0; y < _h; ++y )
+			{
+				const float v	= ( y + 0.5f ) / stepY - 0.5f;
+				const int32 j0	= std::min( std::max( static_cast<int32>( floor( v ) ), 0 ), static_cast<int32>( h ) - 1 );
+				const int32 j1	= std::min( j0 + 1, static_cast<int32>( h ) - 1 );
+				const float fy	= std::min( std::max( v - j0, 0.0f ), 1.0f );
+
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					const float u	= ( x + 0.5f ) / stepX - 0.5f;
+					const int32 i0	= std::min( std::max( static_cast<int32>( floor( u ) ), 0 ), static_cast<int32>( w ) - 1 );
+					const int32 i1	= std::min( i0 + 1, static_cast<int32>( w ) - 1 );
+					const float fx	= std::min( std::max( u - i0, 0.0f ), 1.0f );
+
+					const uint32 id = _rayTracer->primitiveAt( x, y );
+
+					const uint32 taps[4]	= { j0 * w + i0, j0 * w + i1, j1 * w + i0, j1 * w + i1 };
+					// a small floor keeps matching samples at the far corner of the footprint
+					const float weights[4]	= 
+					{ 
+						(1.0f - fx) * (1.0f - fy) + 1e-3f, fx * (1.0f - fy) + 1e-3f,
+						(1.0f - fx) * fy + 1e-3f, fx * fy + 1e-3f 
+					};
+
+					rgb color;
+					float weight = 0.0f;
+
+					for ( uint32 t = 0; t < 4; ++t )
+					{
+						if ( _scaledIds[taps[t]] != id )
+							continue;
+
+						color += _scaledColors[taps[t]] * weights[t];
+						weight += weights[t];
+					}
+
+					if ( weight > 0.0f )
+						setColorBuffer( x, y, color / weight );
+					else
+					{
+						setColorBuffer( x, y, _rayTracer->castRay( x, y ) );
+						++_tracedPixels;
+					}
+				}
+			}
+		}
+
+		/// Renders the next level of the coarse-to-fine preview
+		/**
+			The first level traces every PREVIEW_START_STRIDE-th pixel of every row and column, each level after 
+			it halves the spacing, until the last one has traced all the pixels. Every sample fills the block of 
+			pixels up to the next sample, so each level shows a complete image.
+
+			A level reuses the samples of the previous ones. The new samples of a block whose four corners hit 
+			the same primitive with colors differing by less than PREVIEW_COLOR_THRESHOLD are interpolated from 
+			the corners instead of traced.
+
+			@return spacing of the samples of the rendered level, 0 when the preview was already complete
+		*/
+		uint32 renderPreviewStep()
+		{
+			uint32 stride;
+
+			if ( !_previewStride )
+			{
+				beginRender();
+				_dirty.invalidate();
+
+				stride = PREVIEW_START_STRIDE;
+				_previewIds.assign( _size, NO_PRIMITIVE );
+
+				for ( uint32 y = 0; y < _h; y += stride )
+					for ( uint32 x = 0; x < _w; x += stride )
+						tracePreviewSample( x, y );
+			}
+			else if ( _previewStride == 1 )
+				return 0;
+			else
+			{
+				stride = _previewStride / 2;
+				const uint32 parent = _previewStride;
+
+				for ( uint32 y = 0; y < _h; y += parent )
+				{
+					for ( uint32 x = 0; x < _w; x += parent )
+					{
+						// new samples in the middle of the edges and of the block
+						const uint32 samples[3][2] = { { x + stride, y }, { x, y + stride }, { x + stride, y + stride } };
+
+						const bool uniform = isUniformPreviewBlock( x, y, parent );
+
+						for ( uint32 i = 0; i < 3; ++i )
+						{
+							const uint32 sx = samples[i][0], sy = samples[i][1];
+
+							if ( sx >= _w || sy >= _h )
+								continue;
+
+							if ( uniform )
+							{
+								const float fx = static_cast<float>( sx - x ) / parent, fy = static_cast<float>( sy - y ) / parent;
+
+								rgb color = _colorBuffer[_w * y + x] * ( (1.0f - fx) * (1.0f - fy) );
+								color += _colorBuffer[_w * y + x + parent] * ( fx * (1.0f - fy) );
+								color += _colorBuffer[_w * (y + parent) + x] * ( (1.0f - fx) * fy );
+								color += _colorBuffer[_w * (y + parent) + x + parent] * ( fx * fy );
+
+								setColorBuffer( sx, sy, color );
+								_previewIds[_w * sy + sx] = _previewIds[_w * y + x];
+							}
+							else
+								tracePreviewSample( sx, sy );
+						}
+					}
+				}
+			}
+
+			// every sample fills its block, samples themselves stay untouched
+			for ( uint32 y = 0; y < _h; y += stride )
+			{
+				for ( uint32 x = 0; x < _w; x += stride )
+				{
+					const rgb color = _colorBuffer[_w * y + x];
+
+					for ( uint32 by = y; by < std::min( y + stride, _h ); ++by )
+						for ( uint32 bx = x; bx < std::min( x + stride, _w ); ++bx )
+							setColorBuffer( bx, by, color );
+				}
+			}
+
+			_previewStride = stride;
+			return stride;
+		}
+
+		/// Starts the preview over with the coarsest level, e.g. after the camera moved
+		void resetPreview()
+		{ _previewStride = 0; }
+
+		/// Renders the scene in stages until a deadline
+		/**
+			The stages go in the order of their importance for the image:
+
+				0) primary rays with direct light and DEADLINE_AREA_SAMPLES area light samples for every 
+				   DEADLINE_COARSE_STRIDE-th pixel, filling the blocks (always completed)
+				1) the same for every pixel
+				2) reflected and refracted rays
+				3) the remaining area light samples
+
+			The deadline is checked after every row. An unfinished stage leaves the rows it didn't reach
+			with the result of the previous stage, so the color buffer always holds a complete image.
+
+			@param milliseconds[in] time budget
+			@return sglERenderStages bits of the stages which were skipped or not finished
+		*/
+		uint32 renderSceneWithin( float milliseconds )
+		{
+			const double deadline = wallClock() + milliseconds / 1000.0;
+
+			beginRender();
+			_dirty.invalidate();
+
+			const uint32 samples		= _rayTracer->getAreaLightSamples();
+			const uint32 firstSamples	= std::min( samples, DEADLINE_AREA_SAMPLES );
+			const uint32 stride			= DEADLINE_COARSE_STRIDE;
+
+			_rayTracer->setAreaLightSamples( firstSamples );
+
+			_primaryHits.assign( _size, HitInfo() );
+			_primaryArea.assign( _size, rgb() );
+
+			// coarse primary rays, every sample fills its block
+			for ( uint32 y = 0; y < _h; y += stride )
+			{
+				for ( uint32 x = 0; x < _w; x += stride )
+				{
+					Ray ray = _rayTracer->generateRay( x, y );
+					HitInfo hitInfo;
+					rgb area;
+
+					const rgb color = _rayTracer->castDirect( &ray, &hitInfo, &area );
+
+					for ( uint32 by = y; by < std::min( y + stride, _h ); ++by )
+						for ( uint32 bx = x; bx < std::min( x + stride, _w ); ++bx )
+							setColorBuffer( bx, by, color );
+				}
+			}
+
+			uint32 skipped = 0;
+
+			// primary rays of every pixel
+			for ( uint32 y = 0; y < _h && !skipped; ++y )
+			{
+				if ( wallClock() > deadline )
+				{
+					skipped = SGL_STAGE_PRIMARY | SGL_STAGE_SECONDARY | SGL_STAGE_AREA_SAMPLES;
+					break;
+				}
+
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					const uint32 i = _w * y + x;
+					Ray ray = _rayTracer->generateRay( x, y );
+
+					setColorBuffer( x, y, _rayTracer->castDirect( &ray, &_primaryHits[i], &_primaryArea[i] ) );
+				}
+			}
+
+			// secondary rays, they get all the area light samples right away
+			_rayTracer->setAreaLightSamples( samples );
+
+			for ( uint32 y = 0; y < _h && !skipped; ++y )
+			{
+				if ( wallClock() > deadline )
+				{
+					skipped = SGL_STAGE_SECONDARY | SGL_STAGE_AREA_SAMPLES;
+					break;
+				}
+
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					const uint32 i = _w * y + x;
+					Ray ray = _rayTracer->generateRay( x, y );
+
+					_colorBuffer[i] += _rayTracer->castSecondary( &ray, &_primaryHits[i] );
+				}
+			}
+
+			// the rest of the area light samples, averaged with the first ones
+			const uint32 extraSamples = samples - firstSamples;
+
+			if ( extraSamples && !_rayTracer->usesIrradianceCache() && !_rayTracer->samplesLights() )
+			{
+				_rayTracer->setAreaLightSamples( extraSamples );
+
+				const float firstWeight = static_cast<float>( firstSamples ) / samples;
+				const float extraWeight = static_cast<float>( extraSamples ) / samples;
+
+				for ( uint32 y = 0; y < _h && !skipped; ++y )
+				{
+					if ( wallClock() > deadline )
+					{
+						skipped = SGL_STAGE_AREA_SAMPLES;
+						break;
+					}
+
+					for ( uint32 x = 0; x < _w; ++x )
+					{
+						const uint32 i = _w * y + x;
+
+						Primitive* primitive = _primaryHits[i].getPrimitive();
+						if ( !primitive || primitive->isLight() )
+							continue;
+
+						Ray ray = _rayTracer->generateRay( x, y );
+						rgb area = _primaryArea[i] * firstWeight + _rayTracer->shadeAreaLight( &ray, &_primaryHits[i] ) * extraWeight;
+
+						_colorBuffer[i] += area - _primaryArea[i];
+					}
+				}
+			}
+
+			_rayTracer->setAreaLightSamples( samples );
+
+			return skipped;
+		}
+
+		/// Renders the scene in packets of primary rays along the rows
+		/**
+			@param surfaces[out] optional, surface of every pixel
+		*/
+		void renderScenePackets( surfaceSample* surfaces )
+		{
+			renderRegionPackets( 0, 0, _w, _h, surfaces );
+		}
+
+		/// Renders the scene starting from rasterized primary hits
+		/**
+			The scene is rasterized into a visibility buffer first, see rasterizeVisibility. A pixel whose four
+			neighbours see the same primitive only intersects its ray with that primitive (or takes the background
+			without any intersection) and goes on with shading, shadow, reflected and refracted rays. Pixels on
+			the edges of primitives, where the rasterizer and the ray may disagree, and rays which miss their
+			rasterized primitive are cast against the whole scene.
+
+			Objects thinner than a pixel can vanish from the inside of the background, as with any rasterizer.
+
+			@param surfaces[out] optional, surface of every pixel
+		*/
+		void renderSceneHybrid( surfaceSample* surfaces )
+		{
+			rasterizeVisibility();
+
+			_rasterizedPixels = 0;
+
+			for ( uint32 y = 0; y < _h; ++y )
+			{
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					const uint32 i = _w * y + x;
+
+					Ray ray = _rayTracer->generateRay( x, y );
+					surfaceSample* surface = surfaces ? surfaces + i : NULL;
+					rgb color;
+
+					if ( isInteriorPixel( x, y ) && _rayTracer->castVisibleRay( &ray, _visibleIds[i], color, surface ) )
+						++_rasterizedPixels;
+					else
+						color = _rayTracer->castRay( &ray, surface );
+
+					setColorBuffer( x, y, color );
+				}
+			}
+		}
+
+		/// Renders a fast preview of the scene by rasterization
+		/**
+			A deferred shader: the scene is rasterized into the visibility buffer, then the position of every
+			pixel is unprojected from its depth and shaded by RayTracer::shadePreview, so each pixel is shaded
+			once however many primitives overlap it. Shadows come from the shadow maps when they are enabled,
+			there are no reflections nor refractions. The depth buffer is left with the depth of the visible
+			surfaces.
+		*/
+		void renderSceneRasterized()
+		{
+			beginRender();
+			_dirty.invalidate();
+
+			if ( _shadowMapping )
+				updateShadowMaps();
+
+			rasterizeVisibility();
+
+			const matrix4x4 inverse = _matrix[M_MVP].inverse();
+			std::vector<Primitive*> const& primitives = _rayTracer->getPrimitives();
+
+			for ( uint32 y = 0; y < _h; ++y )
+			{
+				for ( uint32 x = 0; x < _w; ++x )
+				{
+					const uint32 i = _w * y + x;
+
+					Ray ray = _rayTracer->generateRay( x, y );
+					HitInfo hitInfo;
+
+					if ( _visibleIds[i] != NO_PRIMITIVE )
+					{
+						// the depth buffer holds the normalized device z
+						vertex v( deviceX( x ), deviceY( y ), _zbuffer[i], 1.0f );
+						v *= inverse;
+						v.wNormalize();
+
+						const vector3 point( v.x(), v.y(), v.z() );
+						Primitive* primitive = primitives[_visibleIds[i]];
+
+						hitInfo.setPrimitive( primitive );
+						hitInfo.setDistance( ( point - ray.getOrigin() ).length() );
+						hitInfo.setNormal( primitive->normalAt( point ) );
+					}
+
+					setColorBuffer( x, y, _rayTracer->shadePreview( &ray, &hitInfo, _shadowMapping ? &_shadowMaps : NULL ) );
+				}
+			}
+		}
+
+		/// Brings the shadow maps of the preview up to date
+		/**
+			Every point light gets a cube map, every area light AREA_SHADOW_SAMPLES of them. A map is keyed by
+			the geometry and the point it's seen from, so it's rendered again only when the geometry changes or
+			its light moves, color edits keep it.
+		*/
+		void updateShadowMaps()
+		{
+			const uint32 lights		= _rayTracer->getLightCount();
+			const uint32 areaLights	= _rayTracer->getAreaLightCount();
+
+			_shadowMaps.resize( lights + areaLights * AREA_SHADOW_SAMPLES );
+
+			std::vector<Primitive*> const& primitives = _rayTracer->getPrimitives();
+
+			vector3 lower( std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() );
+			vector3 upper = -1.0f * lower;
+
+			for ( std::vector<Primitive*>::const_iterator it = primitives.begin(); it != primitives.end(); ++it )
+			{
+				vector3 l, u;
+				(*it)->getBounds( l, u );
+
+				lower = vector3( std::min( lower.x(), l.x() ), std::min( lower.y(), l.y() ), std::min( lower.z(), l.z() ) );
+				upper = vector3( std::max( upper.x(), u.x() ), std::max( upper.y(), u.y() ), std::max( upper.z(), u.z() ) );
+			}
+
+			for ( uint32 i = 0; i < _shadowMaps.size(); ++i )
+			{
+				const bool pointLight	= i < lights;
+				const uint32 areaLight	= pointLight ? 0 : ( i - lights ) / AREA_SHADOW_SAMPLES;
+
+				const vector3 position = pointLight ? _rayTracer->getLight( i ).getPosition()
+													: _rayTracer->getAreaLight( areaLight )->getShadowSample( ( i - lights ) % AREA_SHADOW_SAMPLES );
+
+				// a patch doesn't shadow its own samples
+				const uint32 ignoreId = pointLight ? NO_PRIMITIVE : _rayTracer->getAreaLightTriangle( areaLight )->getId();
+
+				ContentHash hash = _rayTracer->getSceneHash();
+				hash.add( position );
+				hash.add( ignoreId );
+
+				if ( _shadowMaps[i].getSize() && _shadowMaps[i].getKey() == hash.value() )
+					continue;
+
+				// the farthest corner of the scene bounds
+				const vector3 farthest( std::max( std::abs( lower.x() - position.x() ), std::abs( upper.x() - position.x() ) ),
+										std::max( std::abs( lower.y() - position.y() ), std::abs( upper.y() - position.y() ) ),
+										std::max( std::abs( lower.z() - position.z() ), std::abs( upper.z() - position.z() ) ) );
+
+				_shadowMaps[i].begin( position, primitives.empty() ? 0.0f : farthest.length(), SHADOW_MAP_SIZE, hash.value() );
+				renderShadowMap( _shadowMaps[i], ignoreId );
+
+				++_shadowMapsRendered;
+			}
+		}
+
+		/// Rasterizes the depth of the scene into the faces of a cube map
+		/**
+			The context rasterizer is pointed at each face in turn: its size, depth buffer and matrices are
+			swapped for those of the face and restored afterwards, the color buffer isn't touched.
+
+			@param map[in,out] map prepared by CubeShadowMap::begin
+			@param ignoreId[in] primitive left out of the map, NO_PRIMITIVE for none
+		*/
+		void renderShadowMap( CubeShadowMap& map, uint32 ignoreId )
+		{
+			const uint32 w				= _w;
+			const uint32 h				= _h;
+			float* zbuffer				= _zbuffer;
+			const matrix4x4 mvp			= _matrix[M_MVP];
+			const matrix4x4 viewport	= _matrix[M_VIEWPORT];
+			const bool depthTest		= _depthTest;
+
+			_w = _h = map.getSize();
+			_matrix[M_VIEWPORT] = matrix4x4().viewport( static_cast<float>( _w ), static_cast<float>( _h ), 0.0f, 0.0f );
+
+			_shadowIds.resize( _w * _h );
+			_idBuffer	= &_shadowIds[0];
+			_depthTest	= true;
+
+			for ( uint32 face = 0; face < 6; ++face )
+			{
+				_zbuffer		= map.getFace( face );
+				_matrix[M_MVP]	= map.getFaceMatrix( face );
+
+				const matrix4x4 inverse = _matrix[M_MVP].inverse();
+
+				cullPrimitives();
+
+				for ( std::vector<Primitive*>::const_iterator it = _unculled.begin(); it != _unculled.end(); ++it )
+				{
+					if ( (*it)->getId() == ignoreId )
+						continue;
+
+					if ( const Triangle* triangle = dynamic_cast<const Triangle*>( *it ) )
+						rasterizeTriangle( triangle->a(), triangle->b(), triangle->c() );
+					else if ( const Sphere* sphere = dynamic_cast<const Sphere*>( *it ) )
+						rasterizeSphereDepth( sphere, map.getPosition(), inverse );
+				}
+			}
+
+			_w					= w;
+			_h					= h;
+			_zbuffer			= zbuffer;
+			_matrix[M_MVP]		= mvp;
+			_matrix[M_VIEWPORT]	= viewport;
+			_idBuffer			= NULL;
+			_depthTest			= depthTest;
+		}
+
+		/// Checks whether a pixel sees the same primitive as its four neighbours in the visibility buffer
+		/**
+			Only the viewport is rasterized, the pixels on its border and outside of it are never interior.
+		*/
+		bool isInteriorPixel( uint32 x, uint32 y ) const
+		{
+			const uint32 x0 = _viewport.offsetX(), x1 = std::min( x0 + _viewport.width(), _w );
+			const uint32 y0 = _viewport.offsetY(), y1 = std::min( y0 + _viewport.height(), _h );
+
+			if ( x <= x0 || y <= y0 || x + 1 >= x1 || y + 1 >= y1 )
+				return false;
+
+			const uint32 i	= _w * y + x;
+			const uint32 id	= _visibleIds[i];
+
+			return _visibleIds[i - 1] == id && _visibleIds[i + 1] == id && _visibleIds[i - _w] == id && _visibleIds[i + _w] == id;
+		}
+
+		/// Rasterizes the scene into the visibility buffer
+		/**
+			Every pixel gets the id of the closest primitive, NO_PRIMITIVE for the background, the depth buffer
+			is left with the depth of the visible surfaces. Clusters off the screen are skipped, see
+			cullPrimitives. Triangles go through the scanline polygon filler, spheres are rasterized exactly,
+			see rasterizeSphereVisibility.
+		*/
+		void rasterizeVisibility()
+		{
+			_visibleIds.assign( _size, NO_PRIMITIVE );
+			clearZBuffer();
+
+			const bool depthTest = _depthTest;
+
+			_depthTest	= true;
+			_idBuffer	= &_visibleIds[0];
+
+			cullPrimitives();
+
+			for ( std::vector<Primitive*>::const_iterator it = _unculled.begin(); it != _unculled.end(); ++it )
+			{
+				_fillPrimitive = (*it)->getId();
+
+				if ( const Triangle* triangle = dynamic_cast<const Triangle*>( *it ) )
+					rasterizeTriangle( triangle->a(), triangle->b(), triangle->c() );
+				else if ( const Sphere* sphere = dynamic_cast<const Sphere*>( *it ) )
+					rasterizeSphereVisibility( sphere );
+			}
+
+			_idBuffer	= NULL;
+			_depthTest	= depthTest;
+		}
+
+		/// Collects the primitives which may be seen through the current MVP matrix
+		/**
+			Clusters whose bounding sphere lies behind a plane of the view volume are skipped before any vertex
+			is transformed, see RayTracer::buildClusters. The primitives of a cluster crossing a plane are tested
+			by their own bounding spheres. Primitives added after the last sglEndScene aren't clustered yet and
+			are always kept.
+		*/
+		void cullPrimitives()
+		{
+			std::vector<Primitive*> const& primitives		= _rayTracer->getPrimitives();
+			std::vector<primitiveCluster> const& clusters	= _rayTracer->getClusters();
+
+			const Frustum frustum( _matrix[M_MVP] );
+
+			_unculled.clear();
+
+			uint32 clustered = 0;
+
+			for ( std::vector<primitiveCluster>::const_iterator it = clusters.begin(); it != clusters.end(); ++it )
+			{
+				clustered = it->first + it->count;
+
+				const Frustum::result position = frustum.test( it->center, it->radius );
+
+				if ( position == Frustum::OUTSIDE )
+				{
+					++_culledClusters;
+					_culledPrimitives += it->count;
+				}
+				else if ( position == Frustum::INSIDE )
+					_unculled.insert( _unculled.end(), primitives.begin() + it->first, primitives.begin() + clustered );
+				else
+				{
+					for ( uint32 i = it->first; i < clustered; ++i )
+					{
+						vector3 lower, upper;
+						primitives[i]->getBounds( lower, upper );
+
+						if ( frustum.test( 0.5f * ( lower + upper ), 0.5f * ( upper - lower ).length() ) == Frustum::OUTSIDE )
+							++_culledPrimitives;
+						else
+							_unculled.push_back( primitives[i] );
+					}
+				}
+			}
+
+			_unculled.insert( _unculled.end(), primitives.begin() + std::min( clustered, static_cast<uint32>( primitives.size() ) ), primitives.end() );
+		}
+
+		/// Rasterizes a scene triangle with the current MVP matrix
+		/**
+			The triangle is clipped by the near plane, which the rasterizer itself doesn't do, and by the sides
+			of the view, so no vertex lands far outside of the buffer where the incremental edges of the filler
+			lose precision. The rest is filled by addFilledPolygon.
+		*/
+		void rasterizeTriangle( vector3 const& a, vector3 const& b, vector3 const& c )
+		{
+			// z >= -w, x >= -w, x <= w, y >= -w, y <= w
+			static const float planes[5][4] = { { 0, 0, 1, 1 }, { 1, 0, 0, 1 }, { -1, 0, 0, 1 }, { 0, 1, 0, 1 }, { 0, -1, 0, 1 } };
+
+			// every plane adds at most one vertex
+			vertex polygon[2][8] = { { vertex( a.x(), a.y(), a.z(), 1.0f ), vertex( b.x(), b.y(), b.z(), 1.0f ), vertex( c.x(), c.y(), c.z(), 1.0f ) } };
+			uint32 count = 3;
+
+			for ( uint32 i = 0; i < 3; ++i )
+				polygon[0][i] *= _matrix[M_MVP];
+
+			// Sutherland-Hodgman
+			for ( uint32 p = 0; p < 5 && count >= 3; ++p )
+			{
+				const vertex* in	= polygon[p % 2];
+				vertex* out			= polygon[( p + 1 ) % 2];
+				uint32 outCount		= 0;
+
+				for ( uint32 i = 0; i < count; ++i )
+				{
+					vertex const& from	= in[i];
+					vertex const& to	= in[( i + 1 ) % count];
+
+					const float df = planes[p][0] * from.x() + planes[p][1] * from.y() + planes[p][2] * from.z() + planes[p][3] * from.w();
+					const float dt = planes[p][0] * to.x() + planes[p][1] * to.y() + planes[p][2] * to.z() + planes[p][3] * to.w();
+
+					if ( df >= 0.0f )
+						out[outCount++] = from;
+
+					if ( ( df >= 0.0f ) != ( dt >= 0.0f ) )
+					{
+						const float t = df / ( df - dt );
+
+						out[outCount++] = vertex( from.x() + t * ( to.x() - from.x() ), from.y() + t * ( to.y() - from.y() ),
+												  from.z() + t * ( to.z() - from.z() ), from.w() + t * ( to.w() - from.w() ) );
+					}
+				}
+				count = outCount;
+			}
+
+			if ( count < 3 )
+				return;
+
+			// after five planes the result is in polygon[1]
+			_vertexBuffer.assign( polygon[1], polygon[1] + count );
+
+			for ( VertexIterator it = _vertexBuffer.begin(); it != _vertexBuffer.end(); ++it )
+			{
+				it->wNormalize();
+				*it *= _matrix[M_VIEWPORT];
+			}
+
+			addFilledPolygon();
+			_vertexBuffer.clear();
+		}
+
+		/// Rasterizes a sphere into the visibility buffer
+		/**
+			Pixels inside the projected bounds intersect their ray with the sphere and depth test the hit, so the
+			silhouette is exact and no tessellation is needed.
+		*/
+		void rasterizeSphereVisibility( const Sphere* sphere )
+		{
+			uint32 x0, y0, x1, y1;
+			if ( !projectBounds( sphere, x0, y0, x1, y1 ) )
+				return;
+
+			for ( uint32 y = y0; y <= y1; ++y )
+			{
+				for ( uint32 x = x0; x <= x1; ++x )
+				{
+					Ray ray = _rayTracer->generateRay( x, y );
+					HitInfo hitInfo;
+
+					if ( !sphere->intersect( &ray, &hitInfo ) )
+						continue;
+
+					const vector3 hitPoint = ray.getOrigin() + ( ray.getDirection() * hitInfo.getDistance() );
+
+					vertex v( hitPoint.x(), hitPoint.y(), hitPoint.z(), 1.0f );
+					v *= _matrix[M_MVP];
+					v.wNormalize();
+					v *= _matrix[M_VIEWPORT];
+
+					setPixel( x, y, v.z(), true );
+				}
+			}
+		}
+
+		/// Rasterizes the depth of a sphere seen from a point
+		/**
+			rasterizeSphereVisibility for views other than the camera, the rays of the pixels go from the eye
+			through their points on the far plane.
+
+			@param sphere[in] sphere
+			@param eye[in] center of the projection of the current MVP matrix
+			@param inverse[in] inverse of the current MVP matrix
+		*/
+		void rasterizeSphereDepth( const Sphere* sphere, vector3 const& eye, matrix4x4 const& inverse )
+		{
+			uint32 x0, y0, x1, y1;
+			if ( !projectBounds( sphere, x0, y0, x1, y1 ) )
+				return;
+
+			for ( uint32 y = y0; y <= y1; ++y )
+			{
+				for ( uint32 x = x0; x <= x1; ++x )
+				{
+					vertex target( deviceX( x ), deviceY( y ), 1.0f, 1.0f );
+					target *= inverse;
+					target.wNormalize();
+
+					Ray ray( eye, ( vector3( target.x(), target.y(), target.z() ) - eye ).normalize() );
+					HitInfo hitInfo;
+
+					if ( !sphere->intersect( &ray, &hitInfo ) )
+						continue;
+
+					const vector3 hitPoint = ray.getOrigin() + ( ray.getDirection() * hitInfo.getDistance() );
+
+					vertex v( hitPoint.x(), hitPoint.y(), hitPoint.z(), 1.0f );
+					v *= _matrix[M_MVP];
+					v.wNormalize();
+					v *= _matrix[M_VIEWPORT];
+
+					setPixel( x, y, v.z(), true );
+				}
+			}
+		}
+
+		/// Normalized device x of a pixel column, the inverse of the viewport matrix
+		/**
+			The viewport matrix includes the offset and size set by sglViewport, the shadow map faces
+			set their own, see renderShadowMap.
+		*/
+		float deviceX( float x ) const
+		{ return ( x - _matrix[M_VIEWPORT][3] ) / _matrix[M_VIEWPORT][0]; }
+
+		/// Normalized device y of a pixel row, see deviceX
+		float deviceY( float y ) const
+		{ return ( y - _matrix[M_VIEWPORT][7] ) / _matrix[M_VIEWPORT][5]; }
+
+		/// Pixel rectangle covered by the projected bounding box of a primitive
+		/**
+			@param primitive[in] primitive
+			@param x0[out] left column
+			@param y0[out] bottom row
+			@param x1[out] right column, inclusive
+			@param y1[out] top row, inclusive
+			@return false when the primitive is off the screen
+		*/
+		bool projectBounds( const Primitive* primitive, uint32& x0, uint32& y0, uint32& x1, uint32& y1 ) const
+		{
+			vector3 lower, upper;
+			primitive->getBounds( lower, upper );
+
+			float minX = std::numeric_limits<float>::max(), minY = minX;
+			float maxX = -minX, maxY = -minX;
+
+			for ( uint32 corner = 0; corner < 8; ++corner )
+			{
+				vertex v( corner & 1 ? upper.x() : lower.x(), corner & 2 ? upper.y() : lower.y(), corner & 4 ? upper.z() : lower.z(), 1.0f );
+				v *= _matrix[M_MVP];
+
+				// reaches behind the camera, the projection is unbounded
+				if ( v.w() <= 0.0f )
+				{
+					x0 = y0 = 0;
+					x1 = _w - 1;
+					y1 = _h - 1;
+					return true;
+				}
+
+				v.wNormalize();
+				v *= _matrix[M_VIEWPORT];
+
+				const float x = v.x();
+				const float y = v.y();
+
+				minX = std::min( minX, x );
+				minY = std::min( minY, y );
+				maxX = std::max( maxX, x );
+				maxY = std::max( maxY, y );
+			}
+
+			if ( maxX < 0.0f || maxY < 0.0f || minX >= _w || minY >= _h )
+				return false;
+
+			// clamped before the conversion, a corner close to the camera plane projects far beyond the uint32 range
+			x0 = static_cast<uint32>( std::max( minX, 0.0f ) );
+			y0 = static_cast<uint32>( std::max( minY, 0.0f ) );
+			x1 = static_cast<uint32>( std::min( maxX + 1.0f, static_cast<float>( _w - 1 ) ) );
+			y1 = static_cast<uint32>( std::min( maxY + 1.0f, static_cast<float>( _h - 1 ) ) );
+			return true;
+		}
+
+		/// Enables/disables the hybrid render, see renderSceneHybrid
+		void enableHybridRendering( bool value )
+		{ _hybrid = value; }
+
+		/// Renders the scene of another context from now on, see RayTracer::attachScene
+		/**
+			Primitives and lights added to either context afterwards go to the shared scene. The caches
+			built from the previous scene are dropped, their versions aren't comparable with the new one.
+		*/
+		void attachScene( Context* other )
+		{
+			if ( other->_rayTracer->getScene() == _rayTracer->getScene() )
+				return;
+
+			_rayTracer->attachScene( other->_rayTracer->getScene() );
+
+			_dirty.invalidate();
+			_history.reset( 0, 0, 0 );
+			_relight.invalidate();
+			_shadowMaps.clear();
+			resetPreview();
+		}
+
+		/// Enables/disables the baked diffuse light, see RayTracer::bakeLighting
+		void enableBakedLighting( bool value )
+		{ _rayTracer->enableBakedLighting( value ); }
+
+		/// Bakes the lightmaps which are out of date
+		/**
+			@return number of triangles baked
+		*/
+		uint32 bakeLighting()
+		{ return _rayTracer->bakeLighting(); }
+
+		/// Closest hits of a batch of rays, see RayTracer::intersectRays
+		void intersectRays( const float* origins, const float* directions, uint32 count, float* distances, int32* primitives ) const
+		{ _rayTracer->intersectRays( origins, directions, count, distances, primitives ); }
+
+		/// Occlusion of a batch of rays, see RayTracer::occludeRays
+		void occludeRays( const float* origins, const float* directions, const float* maxDistances, uint32 count, int32* occluded ) const
+		{ _rayTracer->occludeRays( origins, directions, maxDistances, count, occluded ); }
+
+		/// Enables/disables shadow maps in the rasterized preview, see updateShadowMaps
+		void enableShadowMaps( bool value )
+		{ 
+			_shadowMapping = value; 
+
+			if ( !value )
+				_shadowMaps.clear();
+		}
+
+		/// Renders a rectangle of the image in packets of primary rays along the rows
+		/**
+			@param x0[in] X coord of the bottom left corner
+			@param y0[in] Y coord of the bottom left corner
+			@param w[in] width, the rectangle lies inside of the image
+			@param h[in] height
+			@param surfaces[out] optional, surface of every pixel of the image
+		*/
+		void renderRegionPackets( uint32 x0, uint32 y0, uint32 w, uint32 h, surfaceSample* surfaces )
+		{
+			rayPacket packet;
+			rgb colors[RAY_PACKET_SIZE];
+
+			for ( uint32 y = y0; y < y0 + h; ++y )
+			{
+				for ( uint32 x = x0; x < x0 + w; x += RAY_PACKET_SIZE )		
+				{					
+					const uint32 count = std::min( RAY_PACKET_SIZE, x0 + w - x );
+
+					_rayTracer->generatePacket( x, y, packet );
+					_rayTracer->castPacket( packet, count, colors, surfaces ? surfaces + _w * y + x : NULL );
+
+					for ( uint32 i = 0; i < count; ++i )
+						setColorBuffer( x + i, y, colors[i] );				
+				}
+			}
+		}
+
+		/// Renders the scene sharing point light shadow rays between neighbouring pixels
+		/**
+			First traces primary rays and point light shadow rays for a sparse lattice of pixels. A block between
+			four lattice points, whose corners hit the same primitive and agree on a light, is uniformly lit or 
+			shadowed by that light and its pixels skip the shadow ray. Pixels of blocks crossing a shadow boundary
+			(or a primitive edge) trace their own shadow rays.
+
+			The conservative mode uses a denser lattice and a shadowed block also needs all the corners to be
+			occluded by the same primitive.
+
+			@param surfaces[out] optional, surface of every pixel
+		*/
+		void renderSceneSharedShadows( surfaceSample* surfaces )
+		{
+			const uint32 stride		= _conservativeShadows ? SHADOW_LATTICE_STRIDE_CONSERVATIVE : SHADOW_LATTICE_STRIDE;
+			const uint32 lights		= _rayTracer->getLightCount();
+			const uint32 columns	= (_w + stride - 2) / stride + 1;
+			const uint32 rows		= (_h + stride - 2) / stride + 1;
+
+			// lattice point [i, j] sits at pixel [min(i * stride, w - 1), min(j * stride, h - 1)]
+			std::vector<uint32> primitives( columns * rows );
+			std::vector<uint32> occluders( columns * rows * lights );
+
+			for ( uint32 j = 0; j < rows; ++j )
+			{
+				for ( uint32 i = 0; i < columns; ++i )
+				{
+					const uint32 point = j * columns + i;
+					primitives[point] = _rayTracer->primaryVisibility( std::min( i * stride, _w - 1 ), std::min( j * stride, _h - 1 ), &occluders[point * lights] );
+				}
+			}
+
+			std::vector<uint8> hints( lights );
+
+			for ( uint32 by = 0; by + 1 < rows || (by == 0 && rows == 1); ++by )
+			{
+				for ( uint32 bx = 0; bx + 1 < columns || (bx == 0 && columns == 1); ++bx )
+				{
+					const uint32 corners[4] = 
+					{
+						by * columns + bx,
+						by * columns + std::min( bx + 1, columns - 1 ),
+						std::min( by + 1, rows - 1 ) * columns + bx,
+						std::min( by + 1, rows - 1 ) * columns + std::min( bx + 1, columns - 1 )
+					};
+
+					const uint32 primitive = primitives[corners[0]];
+
+					bool samePrimitive = primitive != NO_PRIMITIVE;
+					for ( uint32 c = 1; c < 4; ++c )
+						samePrimitive = samePrimitive && primitives[corners[c]] == primitive;
+
+					if ( samePrimitive )
+					{
+						for ( uint32 l = 0; l < lights; ++l )
+							hints[l] = classifyBlock( &occluders[0], corners, lights, l );
+
+						_rayTracer->setShadowHints( primitive, hints );
+					}
+
+					// pixels of the block, the last row/column of blocks includes the border
+					const uint32 x0 = bx * stride, x1 = ( bx + 2 < columns ) ? x0 + stride : _w;
+					const uint32 y0 = by * stride, y1 = ( by + 2 < rows ) ? y0 + stride : _h;
+
+					for ( uint32 y = y0; y < y1; ++y )
+						for ( uint32 x = x0; x < x1; ++x )
+							setColorBuffer( x, y, _rayTracer->castRay(x, y, surfaces ? surfaces + _w * y + x : NULL) );
+
+					_rayTracer->clearShadowHints();
+				}
+			}
+		}
+
+		/// Classifies the visibility of a light inside a lattice block
+		/**
+			@param occluders[in] lattice occluder ids
+			@param corners[in] lattice points of the block corners
+			@param lights[in] number of point lights
+			@param light[in] light to classify
+			@return shadowHint
+		*/
+		uint8 classifyBlock( const uint32* occluders, const uint32* corners, uint32 lights, uint32 light ) const
+		{
+			const uint32 first = occluders[corners[0] * lights + light];
+			if ( first == SHADOW_UNKNOWN_ID )
+				return SHADOW_UNKNOWN;
+
+			for ( uint32 c = 1; c < 4; ++c )
+			{
+				const uint32 occluder = occluders[corners[c] * lights + light];
+
+				if ( occluder == SHADOW_UNKNOWN_ID )
+					return SHADOW_UNKNOWN;
+
+				// lit and shadowed corners
+				if ( (occluder == NO_PRIMITIVE) != (first == NO_PRIMITIVE) )
+					return SHADOW_UNKNOWN;
+
+				if ( _conservativeShadows && occluder != first )
+					return SHADOW_UNKNOWN;
+			}
+			return first == NO_PRIMITIVE ? SHADOW_LIT : SHADOW_OCCLUDED;
+		}
+
+		/// Returns statistics of the last render
+		sglRenderStats getRenderStats() const
+		{ 
+			sglRenderStats stats = _rayTracer->getStats(); 
+
+			stats.resolutionScale		= _dynamicResolution ? _resolutionScale : 1.0f;
+			stats.upscaleTracedPixels	= _dynamicResolution ? _tracedPixels : 0;
+			stats.temporalReusedPixels	= _temporalReuse ? _reusedPixels : 0;
+			stats.frameCacheHit			= _frameCacheHit ? 1 : 0;
+			stats.regionTracedPixels	= _regionPixels;
+			stats.rasterizedPixels		= _rasterizedPixels;
+			stats.shadowMapsRendered	= _shadowMapsRendered;
+			stats.culledClusters		= _culledClusters;
+			stats.culledPrimitives		= _culledPrimitives;
+
+			return stats;
+		}
+
+		/// Enables/disables rendering at a resolution scaled by the frame time, see renderSceneScaled
+		void enableDynamicResolution( bool value )
+		{ 
+			_dynamicResolution = value; 
+			_resolutionScale = 1.0f;
+		}
+
+		/// Frame time the dynamic resolution aims for, in milliseconds
+		void setFrameTimeTarget( float milliseconds )
+		{ _frameTimeTarget = milliseconds; }
+
+		/// Enables/disables sharing of point light shadow rays between neighbouring pixels
+		void enableShadowSharing( bool value )
+		{ _shareShadows = value; }
+
+		/// Enables/disables the conservative classification of shadow sharing blocks
+		void enableConservativeShadows( bool value )
+		{ _conservativeShadows = value; }
+
+		void setCurrentEmissiveMaterial( float r, float g, float b, float c0, float c1, float c2 )
+		{
+			_currentEmissiveMaterial = new emissiveMaterial( rgb( r, g, b ), c0, c1, c2 );
+		}
+
+		emissiveMaterial* getCurrentEmissiveMaterial()
+		{
+			return _currentEmissiveMaterial;
+		}
+
+		void addAreaLight()
+		{
+			Triangle* triangle = new Triangle(
+						_vectorBuffer[0],
+						_vectorBuffer[1],
+						_vectorBuffer[2]
+					);
+					
+			triangle->setMaterial( _currentMaterial );
+			triangle->setEmissiveMaterial( _currentEmissiveMaterial );
+
+			AreaLight* light = new AreaLight(triangle, _currentEmissiveMaterial);
+
+			_rayTracer->addAreaLight(light);			
+
+			// the emission can be edited, it's hashed by frameKey
+			_rayTracer->getSceneHash().add( _vectorBuffer[0] );
+			_rayTracer->getSceneHash().add( _vectorBuffer[1] );
+			_rayTracer->getSceneHash().add( _vectorBuffer[2] );
+			_rayTracer->getSceneHash().add( _currentMaterial );
+		}
+
+		void setBg( float width, float height, float* bg )
+		{
+			_rayTracer->setEmBackground( width, height, bg );
+		}
+
+		/// Switches between exact (default) and approximate math in shading
+		void enableFastShading( bool value )
+		{
+			_rayTracer->setFastShading( value );
+		}
+
+		void enableIrradianceCache( bool value )
+		{
+			_rayTracer->enableIrradianceCache( value );
+		}
+
+		void setLightSampling( uint32 lightsPerHit )
+		{
+			_rayTracer->setLightSamples( lightsPerHit );
+		}
+
+		void setAreaLightSamples( uint32 samples )
+		{
+			_rayTracer->setAreaLightSamples( samples );
+		}
+
+		void enableDenoise( bool value )
+		{
+			_denoise = value;
+		}
+
+	protected:
+		/// Traces a preview sample and records its primitive
+		void tracePreviewSample( uint32 x, uint32 y )
+		{
+			surfaceSample surface;
+
+			setColorBuffer( x, y, _rayTracer->castRay( x, y, &surface ) );
+			_previewIds[_w * y + x] = surface.primitiveId;
+		}
+
+		/// Checks whether the corners of a preview block agree
+		/**
+			@param x[in] X coord of the top left corner
+			@param y[in] Y coord of the top left corner
+			@param size[in] block size
+			@return true when all four corners are inside the image, hit the same primitive and have similar colors
+		*/
+		bool isUniformPreviewBlock( uint32 x, uint32 y, uint32 size ) const
+		{
+			if ( x + size >= _w || y + size >= _h )
+				return false;
+
+			const uint32 corners[4] = { _w * y + x, _w * y + x + size, _w * (y + size) + x, _w * (y + size) + x + size };
+			const rgb color = _colorBuffer[corners[0]];
+
+			if ( _previewIds[corners[0]] == NO_PRIMITIVE )
+				return false;
+
+			for ( uint32 c = 1; c < 4; ++c )
+			{
+				if ( _previewIds[corners[c]] != _previewIds[corners[0]] )
+					return false;
+
+				const rgb other = _colorBuffer[corners[c]];
+
+				if ( fabs( other.red() - color.red() ) > PREVIEW_COLOR_THRESHOLD ||
+					 fabs( other.green() - color.green() ) > PREVIEW_COLOR_THRESHOLD ||
+					 fabs( other.blue() - color.blue() ) > PREVIEW_COLOR_THRESHOLD )
+					return false;
+			}
+			return true;
+		}
+
+		/// Hands the camera to the ray tracer and resets its per-render state
+		void beginRender()
+		{
+			doMVPMupdate();
+
+			_rayTracer->setInverseMatrix( _matrix[M_MVP].inverse() );
+			_rayTracer->setViewportMatrix( _viewport, _matrix[M_VIEWPORT] );
+			_rayTracer->beginRender();
+
+			_frameCacheHit = false;
+			_rasterizedPixels = 0;
+			_shadowMapsRendered = 0;
+			_culledClusters = 0;
+			_culledPrimitives = 0;
+		}
+
+		void doMVPMupdate()
+		{
+			_matrix[M_MVP] =  _matrix[M_PROJECTION] * _matrix[M_MODELVIEW];
+
+			_updateMVPMneeded = false;
+		}
+
+		void initZBuffer()
+		{			
+			_zbuffer = new float[_w * _h];
+			clearZBuffer();
+		}
+
+	
+
+	private:
+		uint32 _w, _h;
+		uint32 _size;
+		
+		rgb*				_colorBuffer;
+		float*					_zbuffer;
+
+		float					_pointSize;
+
+		rgb				_currentColor;
+		rgb				_clearColor;
+
+		std::vector<vertex>		_vertexBuffer;
+		std::vector<vector3>	_vectorBuffer;
+		std::vector<matrix4x4>*	_matrixStack;
+		std::vector<uint32>		_edgeBuffer;
+		
+		viewport				_viewport;
+		
+		matrix4x4				_matrix[M_SIZE];
+
+		sglEMatrixMode			_currentMatrixMode;
+		sglEAreaMode			_currentAreaMode;
+		sglEElementType			_drawingMode;
+
+		bool					_inCycle;
+		bool					_depthTest;
+		bool					_updateMVPMneeded;
+
+		std::vector<edge>		_nonActiveEdges;
+		std::vector<edge>		_edgeBeginnings;
+		std::vector<edge>		_edgesEnds;
+		std::vector<edge>		_activeEdges;
+
+		/// Tile of a view, see renderViews
+		struct viewTile
+		{
+			viewTile( uint32 view, uint32 x, uint32 y )
+				: view(view), x(x), y(y)
+			{ }
+
+			uint32 view;
+			uint32 x, y;		///< bottom left corner
+		};
+
+		// RayTracer
+		bool					_isDefiningScene;
+		RayTracer*				_rayTracer;
+		material				_currentMaterial;
+		emissiveMaterial*		_currentEmissiveMaterial;
+
+		bool					_shareShadows;
+		bool					_conservativeShadows;
+
+		bool						_denoise;
+		Denoiser					_denoiser;
+		std::vector<surfaceSample>	_surfaces;
+
+		// dynamic resolution
+		bool						_dynamicResolution;
+		float						_frameTimeTarget;
+		float						_lastFrameTime;		///< milliseconds
+		float						_resolutionScale;
+		uint32						_tracedPixels;
+		std::vector<rgb>			_scaledColors;
+		std::vector<uint32>			_scaledIds;
+
+		// temporal reuse
+		bool						_temporalReuse;
+		TemporalHistory				_history;
+		uint32						_reusedPixels;
+
+		// relighting
+		bool						_relightCache;
+		RelightCache				_relight;
+
+		// frame cache
+		bool						_frameCache;
+		bool						_frameCacheHit;		///< the last renderScene copied a cached image
+		FrameCache					_frames;
+
+		// regions
+		DirtyRegion					_dirty;
+		uint32						_regionPixels;		///< traced by the last render
+
+		// visibility buffer
+		uint32*						_idBuffer;			///< the filled polygons write _fillPrimitive here instead of colors, see setPixel
+		uint32						_fillPrimitive;
+		std::vector<uint32>			_visibleIds;
+
+		// culling
+		std::vector<Primitive*>		_unculled;			///< see cullPrimitives
+		uint32						_culledClusters;	///< summed over the rasterization passes of the last render
+		uint32						_culledPrimitives;
+
+		// hybrid render
+		bool						_hybrid;
+		uint32						_rasterizedPixels;
+
+		// shadow maps
+		bool						_shadowMapping;
+		std::vector<CubeShadowMap>	_shadowMaps;		///< see updateShadowMaps for the order
+		std::vector<uint32>			_shadowIds;			///< visibility buffer the faces are rasterized with
+		uint32						_shadowMapsRendered;
+
+		// coarse-to-fine preview
+		uint32						_previewStride;		///< spacing of the last rendered level, 0 before the first one
+		std::vector<uint32>			_previewIds;
+
+		// deadline render
+		std::vector<HitInfo>		_primaryHits;
+		std::vector<rgb>			_primaryArea;
 
 		float _emBgW, _emBgH;
 		float * _emBg;
@@ -14,6 +14,8 @@ class ContextManager
 		void setCurrentContext(Context* c){ _currentContext = c; }
 		void setCurrentContext(uint32 id){ _currentContext = _contextContainer[id]; }
 
+		Context* context(uint32 id){ return _contextContainer[id]; }
+
 		uint32 contextId(){ return _contextContainer.size()-1; }
 		uint32 contextSize(){ return _contextContainer.size(); }
 
@@ -0,0 +1,151 @@
+#ifndef __DENOISER_H__
+#define __DENOISER_H__
+
+#include <vector>
+#include <cmath>
+
+/// Surface seen through a pixel, written during the render to guide the denoiser
+struct surfaceSample
+{
+	public:
+		surfaceSample()
+			: depth(std::numeric_limits<float>::max()), albedo(WHITE), primitiveId(NO_PRIMITIVE)
+		{ }
+
+		vector3	normal;
+		float	depth;			///< distance along the primary ray
+		rgb		albedo;			///< diffuse reflectance, color * kd
+		uint32	primitiveId;	///< NO_PRIMITIVE for the background
+		rgb		sampled;		///< noisy part of the pixel color, see RayTracer::shadeHit
+};
+
+/// Edge-aware a-trous wavelet denoiser
+/**
+	Only the noisy part of the image is filtered, the light of sampled area lights at the primary hits. Point
+	lights, reflections and refractions are exact and stay sharp. The albedo is divided out before filtering
+	and multiplied back afterwards, so textures and material colors aren't blurred either.
+
+	The filter is a 5x5 B3 spline kernel whose taps are spread 2^i pixels apart in the i-th iteration
+	(Dammertz et al., Edge-Avoiding A-Trous Wavelet Transform). The weight of a tap is lowered when its
+	irradiance, normal or depth differ from the center pixel and it is zero for a different primitive, so the
+	noise of soft shadows is smoothed while geometric edges stay sharp.
+*/
+class Denoiser
+{
+	public:
+		Denoiser( uint32 iterations = DENOISE_ITERATIONS )
+			: _iterations(iterations)
+		{ }
+
+		/// Filters an image
+		/**
+			@param colors[in, out] image, w * h pixels
+			@param surfaces[in] surface of every pixel
+			@param w[in] width
+			@param h[in] height
+		*/
+		void denoise( rgb* colors, const surfaceSample* surfaces, uint32 w, uint32 h )
+		{
+			const int32 size = static_cast<int32>( w * h );
+
+			_source.resize( size );
+			_target.resize( size );
+
+			for ( int32 i = 0; i < size; ++i )
+				_source[i] = demodulate( surfaces[i].sampled, surfaces[i].albedo );
+
+			float sigmaColor = DENOISE_SIGMA_COLOR;
+
+			for ( uint32 iteration = 0; iteration < _iterations; ++iteration )
+			{
+				const int32 step = 1 << iteration;
+
+				#pragma omp parallel for schedule(dynamic)
+				for ( int32 y = 0; y < static_cast<int32>( h ); ++y )
+					for ( int32 x = 0; x < static_cast<int32>( w ); ++x )
+						_target[y * w + x] = filter( x, y, w, h, step, sigmaColor, surfaces );
+
+				_source.swap( _target );
+
+				// finer details were already smoothed, the coarser levels only blend similar colors
+				sigmaColor *= 0.5f;
+			}
+
+			for ( int32 i = 0; i < size; ++i )
+				colors[i] += modulate( _source[i], surfaces[i].albedo ) - surfaces[i].sampled;
+		}
+
+	private:
+		/// One tap of the filter at [x, y]
+		rgb filter( int32 x, int32 y, int32 w, int32 h, int32 step, float sigmaColor, const surfaceSample* surfaces ) const
+		{
+			static const float kernel[3] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+			const int32 center				= y * w + x;
+			const surfaceSample& surface	= surfaces[center];
+			const rgb color					= _source[center];
+
+			// the background has nothing to denoise
+			if ( surface.primitiveId == NO_PRIMITIVE )
+				return color;
+
+			const float luminance		= color.luminance();
+			const float colorFalloff	= 1.0f / ( sigmaColor * sigmaColor );
+			const float depthFalloff	= 1.0f / ( DENOISE_SIGMA_DEPTH * surface.depth * step );
+
+			rgb sum;
+			float weights = 0.0f;
+
+			for ( int32 j = -2; j <= 2; ++j )
+			{
+				const int32 ty = y + j * step;
+				if ( ty < 0 || ty >= h )
+					continue;
+
+				for ( int32 i = -2; i <= 2; ++i )
+				{
+					const int32 tx = x + i * step;
+					if ( tx < 0 || tx >= w )
+						continue;
+
+					const int32 tap				= ty * w + tx;
+					const surfaceSample& other	= surfaces[tap];
+
+					if ( other.primitiveId != surface.primitiveId )
+						continue;
+
+					const float cosine = math::vec::scalarProduct( surface.normal, other.normal );
+					if ( cosine <= 0.0f )
+						continue;
+
+					const float dl = _source[tap].luminance() - luminance;
+
+					const float weight = kernel[abs(i)] * kernel[abs(j)]
+						* math::powi( cosine, DENOISE_NORMAL_POWER )
+						* exp( -fabs( other.depth - surface.depth ) * depthFalloff - dl * dl * colorFalloff );
+
+					sum += _source[tap] * weight;
+					weights += weight;
+				}
+			}
+
+			// the center tap has a positive weight
+			return sum / weights;
+		}
+
+		static rgb demodulate( rgb const& color, rgb const& albedo )
+		{ return rgb( color.red() / albedoFloor( albedo.red() ), color.green() / albedoFloor( albedo.green() ), color.blue() / albedoFloor( albedo.blue() ) ); }
+
+		static rgb modulate( rgb const& irradiance, rgb const& albedo )
+		{ return rgb( irradiance.red() * albedoFloor( albedo.red() ), irradiance.green() * albedoFloor( albedo.green() ), irradiance.blue() * albedoFloor( albedo.blue() ) ); }
+
+		/// Black albedo channels have nothing to demodulate
+		static float albedoFloor( float albedo )
+		{ return std::max( albedo, 0.01f ); }
+
+		uint32				_iterations;
+
+		std::vector<rgb>	_source, _target;
+};
+
+#endif
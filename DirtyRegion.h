@@ -0,0 +1,98 @@
+#ifndef __DIRTY_REGION_H__
+#define __DIRTY_REGION_H__
+
+#include <vector>
+#include <algorithm>
+
+/// Tiles of the last rendered image which light edits made outdated
+/**
+	The image stays a valid base for re-tracing only the dirty tiles as long as the camera, the viewport and
+	the geometry don't change, light edits update the scene version the region was rendered from.
+*/
+class DirtyRegion
+{
+	public:
+		DirtyRegion()
+			: _valid(false), _w(0), _h(0), _sceneVersion(0), _tilesX(0), _tilesY(0)
+		{ }
+
+		/// Starts tracking a newly rendered image, all the tiles are clean
+		void reset( uint32 w, uint32 h, matrix4x4 const& mvp, uint32 sceneVersion )
+		{
+			_w = w;
+			_h = h;
+			_mvp = mvp;
+			_sceneVersion = sceneVersion;
+			_valid = true;
+
+			_tilesX = ( w + DIRTY_TILE_SIZE - 1 ) / DIRTY_TILE_SIZE;
+			_tilesY = ( h + DIRTY_TILE_SIZE - 1 ) / DIRTY_TILE_SIZE;
+			_dirty.assign( _tilesX * _tilesY, false );
+		}
+
+		void invalidate()
+		{ _valid = false; }
+
+		/// Checks whether the image can still be updated tile by tile
+		bool isValid( uint32 w, uint32 h, matrix4x4 const& mvp, uint32 sceneVersion ) const
+		{
+			if ( !_valid || w != _w || h != _h || sceneVersion != _sceneVersion )
+				return false;
+
+			for ( uint32 i = 0; i < 16; ++i )
+				if ( mvp[i] != _mvp[i] )
+					return false;
+
+			return true;
+		}
+
+		/// Light edits keep the region valid, see mark
+		void update( uint32 sceneVersion )
+		{ _sceneVersion = sceneVersion; }
+
+		/// Marks the tiles overlapping a rectangle
+		/**
+			@param x0[in] left edge in pixels, may lie outside of the image
+			@param y0[in] bottom edge
+			@param x1[in] right edge
+			@param y1[in] top edge
+		*/
+		void mark( float x0, float y0, float x1, float y1 )
+		{
+			if ( x1 < 0.0f || y1 < 0.0f || x0 >= _w || y0 >= _h )
+				return;
+
+			// clamped to the image before the conversion, the edges may lie beyond the uint32 range
+			const uint32 tx0 = static_cast<uint32>( std::max( x0, 0.0f ) ) / DIRTY_TILE_SIZE;
+			const uint32 ty0 = static_cast<uint32>( std::max( y0, 0.0f ) ) / DIRTY_TILE_SIZE;
+			const uint32 tx1 = static_cast<uint32>( std::min( x1, static_cast<float>( _w - 1 ) ) ) / DIRTY_TILE_SIZE;
+			const uint32 ty1 = static_cast<uint32>( std::min( y1, static_cast<float>( _h - 1 ) ) ) / DIRTY_TILE_SIZE;
+
+			for ( uint32 ty = ty0; ty <= ty1; ++ty )
+				for ( uint32 tx = tx0; tx <= tx1; ++tx )
+					_dirty[ty * _tilesX + tx] = true;
+		}
+
+		void markAll()
+		{ _dirty.assign( _tilesX * _tilesY, true ); }
+
+		bool isDirty( uint32 tx, uint32 ty ) const
+		{ return _dirty[ty * _tilesX + tx]; }
+
+		uint32 getTilesX() const
+		{ return _tilesX; }
+
+		uint32 getTilesY() const
+		{ return _tilesY; }
+
+	private:
+		bool				_valid;
+		uint32				_w, _h;
+		matrix4x4			_mvp;
+		uint32				_sceneVersion;
+
+		uint32				_tilesX, _tilesY;
+		std::vector<bool>	_dirty;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef __FRAME_CACHE_H__
+#define __FRAME_CACHE_H__
+
+#include <list>
+#include <vector>
+#include <algorithm>
+
+/// 64-bit FNV-1a hash, fed value by value
+class ContentHash
+{
+	public:
+		ContentHash()
+			: _value(14695981039346656037ULL)
+		{ }
+
+		void add( const void* data, uint32 size )
+		{
+			const uint8* bytes = static_cast<const uint8*>( data );
+
+			for ( uint32 i = 0; i < size; ++i )
+			{
+				_value ^= bytes[i];
+				_value *= 1099511628211ULL;
+			}
+		}
+
+		void add( uint32 value )
+		{ add( &value, sizeof( value ) ); }
+
+		/// Floats are hashed by their bits, -0 and 0 differ
+		void add( float value )
+		{ add( &value, sizeof( value ) ); }
+
+		void add( vector3 const& v )
+		{
+			add( v.x() );
+			add( v.y() );
+			add( v.z() );
+		}
+
+		void add( rgb const& color )
+		{
+			add( color.red() );
+			add( color.green() );
+			add( color.blue() );
+		}
+
+		void add( material const& m )
+		{
+			add( m.color() );
+			add( m.diffuse() );
+			add( m.specular() );
+			add( m.shine() );
+			add( m.transmittence() );
+			add( m.refraction() );
+		}
+
+		void add( emissiveMaterial const& em )
+		{
+			add( em.color() );
+			add( em.c0() );
+			add( em.c1() );
+			add( em.c2() );
+		}
+
+		void add( matrix4x4 const& matrix )
+		{
+			for ( uint32 i = 0; i < 16; ++i )
+				add( matrix[i] );
+		}
+
+		uint64 value() const
+		{ return _value; }
+
+	private:
+		uint64	_value;
+};
+
+/// Recently rendered images keyed by the hash of everything they were rendered from
+/**
+	Holds at most FRAME_CACHE_SIZE images, the least recently used one is dropped first.
+*/
+class FrameCache
+{
+	public:
+		/// Copies a cached image to the color buffer
+		/**
+			@param key[in] hash of the scene, camera and settings, see Context::frameKey
+			@param colors[out] color buffer
+			@param size[in] pixels of the color buffer
+			@return true on a hit
+		*/
+		bool find( uint64 key, rgb* colors, uint32 size )
+		{
+			for ( std::list<frame>::iterator it = _frames.begin(); it != _frames.end(); ++it )
+			{
+				if ( it->key != key || it->colors.size() != size )
+					continue;
+
+				std::copy( it->colors.begin(), it->colors.end(), colors );
+
+				// most recently used first
+				_frames.splice( _frames.begin(), _frames, it );
+				return true;
+			}
+			return false;
+		}
+
+		/// Stores a rendered image
+		void insert( uint64 key, const rgb* colors, uint32 size )
+		{
+			if ( _frames.size() >= FRAME_CACHE_SIZE )
+				_frames.pop_back();
+
+			_frames.push_front( frame() );
+			_frames.front().key = key;
+			_frames.front().colors.assign( colors, colors + size );
+		}
+
+		void clear()
+		{ _frames.clear(); }
+
+	private:
+		struct frame
+		{
+			uint64				key;
+			std::vector<rgb>	colors;
+		};
+
+		std::list<frame>	_frames;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef __FRUSTUM_H__
+#define __FRUSTUM_H__
+
+#include <cmath>
+
+/// Consecutive scene primitives bounded by a sphere, see RayTracer::buildClusters
+struct primitiveCluster
+{
+	public:
+		primitiveCluster()
+			: first(0), count(0), radius(0.0f)
+		{ }
+
+		uint32	first;		///< id of the first primitive
+		uint32	count;
+		vector3	center;
+		float	radius;
+};
+
+/// Planes of the view volume of a MVP matrix
+/**
+	The planes are extracted from the rows of the matrix (Gribb and Hartmann): a point is inside when
+	-w <= x <= w, -w <= y <= w and z >= -w in the clip space. The far plane is left out, the rasterizer
+	doesn't clip by it either.
+*/
+class Frustum
+{
+	public:
+		Frustum( matrix4x4 const& mvp )
+		{
+			for ( uint32 i = 0; i < 4; ++i )
+			{
+				_planes[0][i] = mvp[12 + i] + mvp[i];		// left
+				_planes[1][i] = mvp[12 + i] - mvp[i];		// right
+				_planes[2][i] = mvp[12 + i] + mvp[4 + i];	// bottom
+				_planes[3][i] = mvp[12 + i] - mvp[4 + i];	// top
+				_planes[4][i] = mvp[12 + i] + mvp[8 + i];	// near
+			}
+
+			for ( uint32 p = 0; p < PLANES; ++p )
+			{
+				const float length = std::sqrt( _planes[p][0] * _planes[p][0] + _planes[p][1] * _planes[p][1] + _planes[p][2] * _planes[p][2] );
+
+				if ( length > 0.0f )
+					for ( uint32 i = 0; i < 4; ++i )
+						_planes[p][i] /= length;
+			}
+		}
+
+		enum result
+		{
+			OUTSIDE,		///< completely behind one of the planes
+			INTERSECTS,
+			INSIDE			///< in front of all the planes
+		};
+
+		/// Position of a sphere relative to the view volume
+		result test( vector3 const& center, float radius ) const
+		{
+			result position = INSIDE;
+
+			for ( uint32 p = 0; p < PLANES; ++p )
+			{
+				const float distance = _planes[p][0] * center.x() + _planes[p][1] * center.y() + _planes[p][2] * center.z() + _planes[p][3];
+
+				if ( distance < -radius )
+					return OUTSIDE;
+				if ( distance < radius )
+					position = INTERSECTS;
+			}
+			return position;
+		}
+
+	private:
+		enum { PLANES = 5 };
+
+		float	_planes[PLANES][4];		///< normals point inside
+};
+
+#endif
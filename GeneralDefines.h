@@ -2,11 +2,17 @@
 #define __DEFINES_H__
 
 #include <limits>
+#include <ctime>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // Type definitions
 typedef		unsigned char	uint8;
 typedef		unsigned short	uint16;
 typedef		unsigned int	uint32;
+typedef		unsigned long long	uint64;
 
 typedef		char			int8;
 typedef		short			int16;
@@ -24,6 +30,75 @@ const float ARC_SEGMENTS_F		= 40.0f;
 
 const float Z_BUFFER_INFINITY	= std::numeric_limits<float>::max();
 
+// Threads
+/// Index of the calling thread inside the current parallel region (0 without OpenMP)
+inline uint32 threadIndex()
+{
+#ifdef _OPENMP
+	return static_cast<uint32>( omp_get_thread_num() );
+#else
+	return 0;
+#endif
+}
+
+/// Maximal number of threads a parallel region can use
+inline uint32 threadCount()
+{
+#ifdef _OPENMP
+	return static_cast<uint32>( omp_get_max_threads() );
+#else
+	return 1;
+#endif
+}
+
+/// Time in seconds, for render deadlines
+/**
+	Wall clock with OpenMP, otherwise the CPU time of the process, which matches it for a single thread.
+*/
+inline double wallClock()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return static_cast<double>( clock() ) / CLOCKS_PER_SEC;
+#endif
+}
+
+/// Xorshift pseudo random numbers, every thread keeps its own generator instead of sharing rand()
+class RandomGenerator
+{
+	public:
+		RandomGenerator( uint32 seed = 0 )
+		{ setSeed( seed ); }
+
+		/// Restarts the sequence, equal seeds give equal sequences
+		void setSeed( uint32 seed )
+		{
+			// mixed, so that neighbouring seeds start unrelated sequences
+			seed ^= seed >> 16;
+			seed *= 0x7feb352dU;
+			seed ^= seed >> 15;
+			seed *= 0x846ca68bU;
+			seed ^= seed >> 16;
+
+			// zero is a fixed point of xorshift
+			_state = seed ? seed : 0x9e3779b9U;
+		}
+
+		/// Uniform number in [0, 1)
+		float next()
+		{
+			_state ^= _state << 13;
+			_state ^= _state >> 17;
+			_state ^= _state << 5;
+
+			return static_cast<float>( _state >> 8 ) * ( 1.0f / 16777216.0f );
+		}
+
+	private:
+		uint32 _state;
+};
+
 enum contextMatrices
 {
 	M_MVP,
@@ -0,0 +1,213 @@
+#ifndef __IRRADIANCE_CACHE_H__
+#define __IRRADIANCE_CACHE_H__
+
+#include <vector>
+#include <cmath>
+
+/// Statistics of the shadow rays used to compute an irradiance cache record
+struct irradianceSampling
+{
+	public:
+		irradianceSampling()
+			: _inverseDistances(0.0f), _distances(0), _visible(0), _occluded(0)
+		{ }
+
+		void addDistance( float distance )
+		{
+			_inverseDistances += 1.0f / std::max( distance, IRRADIANCE_CACHE_MIN_RADIUS );
+			++_distances;
+		}
+
+		void addVisibility( bool visible )
+		{ visible ? ++_visible : ++_occluded; }
+
+		/// Validity radius of the record
+		/**
+			Harmonic mean of the distances to the light samples (as in Ward's cache). The irradiance changes
+			quickly inside soft shadows, so records computed there get a much smaller radius.
+		*/
+		float radius() const
+		{
+			if ( !_distances )
+				return IRRADIANCE_CACHE_MIN_RADIUS;
+
+			float radius = _distances / _inverseDistances;
+			if ( _visible && _occluded )
+				radius *= IRRADIANCE_CACHE_PENUMBRA_SCALE;
+
+			return radius;
+		}
+
+	private:
+		float	_inverseDistances;
+		uint32	_distances;
+		uint32	_visible, _occluded;
+};
+
+/// Irradiance cache
+/**
+	A Ward-style irradiance cache. Irradiance sampled at sparse world points is stored together with
+	the surface normal and a validity radius. Another point reuses the stored samples whose weight
+
+		w = 1 / ( |p - p_i| / R_i + sqrt(1 - n . n_i) )
+
+	is above 1 / accuracy and interpolates between them. Records don't depend on the camera, so they
+	stay valid until the scene or its lights change.
+
+	Records are kept in a hashed multi-level grid. A record goes to the level whose cell size covers
+	its validity sphere and is inserted into every cell the sphere overlaps, so a lookup only visits
+	one cell per used level.
+*/
+class IrradianceCache
+{
+	public:
+		IrradianceCache( float accuracy = IRRADIANCE_CACHE_ACCURACY )
+			: _accuracy(accuracy), _minLevel(std::numeric_limits<int32>::max()), _maxLevel(std::numeric_limits<int32>::min())
+		{
+			_buckets.resize( IRRADIANCE_CACHE_BUCKETS );
+		}
+
+		/// Interpolates the irradiance at a point from the stored records
+		/**
+			@param point[in] world position
+			@param normal[in] surface normal
+			@param irradiance[out] interpolated irradiance
+			@return false when no record is close enough
+		*/
+		bool lookup( vector3 const& point, vector3 const& normal, rgb& irradiance ) const
+		{
+			if ( _records.empty() )
+				return false;
+
+			rgb sum;
+			float weights = 0.0f;
+
+			for ( int32 level = _minLevel; level <= _maxLevel; ++level )
+			{
+				const float cell = cellSize( level );
+
+				const std::vector<uint32>& bucket = _buckets[ hash( level,
+					static_cast<int32>( floor( point.x() / cell ) ),
+					static_cast<int32>( floor( point.y() / cell ) ),
+					static_cast<int32>( floor( point.z() / cell ) ) ) ];
+
+				for ( std::vector<uint32>::const_iterator it = bucket.begin(); it != bucket.end(); ++it )
+				{
+					const record& r = _records[*it];
+
+					// hash collisions bring in records from other levels, skip them so that
+					// a record isn't counted twice
+					if ( r.level != level )
+						continue;
+
+					const vector3 d = point - r.position;
+
+					// the record lies in front of the point
+					if ( math::vec::scalarProduct( d, normal + r.normal ) < -0.1f * r.radius )
+						continue;
+
+					float error = d.length() / r.radius + sqrtf( std::max( 0.0f, 1.0f - math::vec::scalarProduct( normal, r.normal ) ) );
+					if ( error * _accuracy >= 1.0f )
+						continue;
+
+					float w = 1.0f / std::max( error, 1e-4f );
+					sum += r.irradiance * w;
+					weights += w;
+				}
+			}
+
+			if ( weights <= 0.0f )
+				return false;
+
+			irradiance = sum / weights;
+			return true;
+		}
+
+		/// Stores a new record
+		/**
+			@param point[in] world position
+			@param normal[in] surface normal
+			@param irradiance[in] sampled irradiance
+			@param radius[in] distance over which the irradiance is expected to stay smooth
+		*/
+		void insert( vector3 const& point, vector3 const& normal, rgb const& irradiance, float radius )
+		{
+			radius = std::max( radius, IRRADIANCE_CACHE_MIN_RADIUS );
+
+			// lookup takes records up to radius / accuracy from their position
+			const float reach = radius / _accuracy;
+			const int32 level = static_cast<int32>( ceil( log( reach ) / log( 2.0f ) ) );
+			const float cell = cellSize( level );
+
+			record r;
+			r.position		= point;
+			r.normal		= normal;
+			r.irradiance	= irradiance;
+			r.radius		= radius;
+			r.level			= level;
+
+			const uint32 index = _records.size();
+			_records.push_back( r );
+
+			const int32 x0 = static_cast<int32>( floor( (point.x() - reach) / cell ) ), x1 = static_cast<int32>( floor( (point.x() + reach) / cell ) );
+			const int32 y0 = static_cast<int32>( floor( (point.y() - reach) / cell ) ), y1 = static_cast<int32>( floor( (point.y() + reach) / cell ) );
+			const int32 z0 = static_cast<int32>( floor( (point.z() - reach) / cell ) ), z1 = static_cast<int32>( floor( (point.z() + reach) / cell ) );
+
+			for ( int32 z = z0; z <= z1; ++z )
+				for ( int32 y = y0; y <= y1; ++y )
+					for ( int32 x = x0; x <= x1; ++x )
+					{
+						// two cells of the record may share a bucket
+						std::vector<uint32>& bucket = _buckets[ hash( level, x, y, z ) ];
+						if ( bucket.empty() || bucket.back() != index )
+							bucket.push_back( index );
+					}
+
+			_minLevel = std::min( _minLevel, level );
+			_maxLevel = std::max( _maxLevel, level );
+		}
+
+		/// Drops all the records, called whenever the scene or its lights change
+		void clear()
+		{
+			_records.clear();
+			for ( std::vector< std::vector<uint32> >::iterator it = _buckets.begin(); it != _buckets.end(); ++it )
+				it->clear();
+
+			_minLevel = std::numeric_limits<int32>::max();
+			_maxLevel = std::numeric_limits<int32>::min();
+		}
+
+		uint32 size() const
+		{ return _records.size(); }
+
+	private:
+		struct record
+		{
+			vector3	position;
+			vector3	normal;
+			rgb		irradiance;
+			float	radius;
+			int32	level;
+		};
+
+		static float cellSize( int32 level )
+		{ return ldexp( 1.0f, level ); }
+
+		static uint32 hash( int32 level, int32 x, int32 y, int32 z )
+		{
+			uint32 h = static_cast<uint32>(level) * 0x9E3779B1u;
+			h ^= static_cast<uint32>(x) * 73856093u;
+			h ^= static_cast<uint32>(y) * 19349663u;
+			h ^= static_cast<uint32>(z) * 83492791u;
+			return h % IRRADIANCE_CACHE_BUCKETS;
+		}
+
+		float								_accuracy;
+		int32								_minLevel, _maxLevel;
+
+		std::vector<record>					_records;
+		std::vector< std::vector<uint32> >	_buckets;
+};
+
+#endif
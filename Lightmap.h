@@ -0,0 +1,103 @@
+#ifndef __LIGHTMAP_H__
+#define __LIGHTMAP_H__
+
+#include <vector>
+#include <algorithm>
+
+/// Diffuse irradiance baked over a triangle
+/**
+	The triangle is split into subdivisions^2 smaller ones, the irradiance is stored at their corners and
+	interpolated linearly inside them. A corner [i, j] lies at a + i / n * edge1 + j / n * edge2. Point and
+	area lights are kept apart, so each can replace its own term of the shading. Values don't include the
+	material, see RayTracer::bakeLighting.
+*/
+class Lightmap
+{
+	public:
+		Lightmap()
+			: _subdivisions(0), _valid(false)
+		{ }
+
+		/// Starts baking with a given resolution
+		void begin( uint32 subdivisions )
+		{
+			_subdivisions = subdivisions;
+			_valid = false;
+
+			const uint32 corners = ( subdivisions + 1 ) * ( subdivisions + 2 ) / 2;
+			_direct.assign( corners, rgb() );
+			_area.assign( corners, rgb() );
+		}
+
+		/// Marks the lightmap complete
+		void end()
+		{ _valid = true; }
+
+		void invalidate()
+		{ _valid = false; }
+
+		bool isValid() const
+		{ return _valid; }
+
+		uint32 getSubdivisions() const
+		{ return _subdivisions; }
+
+		/// Stores the irradiance of a corner, i + j <= subdivisions
+		void set( uint32 i, uint32 j, rgb const& direct, rgb const& area )
+		{
+			_direct[index( i, j )]	= direct;
+			_area[index( i, j )]	= area;
+		}
+
+		/// Interpolates the irradiance at a point of the triangle
+		/**
+			@param u[in] barycentric coordinate along edge1
+			@param v[in] barycentric coordinate along edge2
+			@param direct[out] irradiance of the point lights
+			@param area[out] irradiance of the area lights
+		*/
+		void lookup( float u, float v, rgb& direct, rgb& area ) const
+		{
+			const float n = static_cast<float>( _subdivisions );
+
+			const float s = std::min( std::max( u * n, 0.0f ), n );
+			const float t = std::min( std::max( v * n, 0.0f ), n - s );
+
+			const uint32 i = std::min( static_cast<uint32>( s ), _subdivisions - 1 );
+			const uint32 j = std::min( static_cast<uint32>( t ), _subdivisions - 1 - i );
+
+			const float fs = s - i;
+			const float ft = t - j;
+
+			// the upper triangle of the cell exists unless the cell lies on the diagonal edge
+			if ( fs + ft > 1.0f && i + j + 2 <= _subdivisions )
+			{
+				const uint32 c0 = index( i + 1, j + 1 ), c1 = index( i + 1, j ), c2 = index( i, j + 1 );
+				const float w0 = fs + ft - 1.0f, w1 = 1.0f - ft, w2 = 1.0f - fs;
+
+				direct	= w0 * _direct[c0] + w1 * _direct[c1] + w2 * _direct[c2];
+				area	= w0 * _area[c0] + w1 * _area[c1] + w2 * _area[c2];
+			}
+			else
+			{
+				const uint32 c0 = index( i, j ), c1 = index( i + 1, j ), c2 = index( i, j + 1 );
+				const float w0 = 1.0f - fs - ft, w1 = fs, w2 = ft;
+
+				direct	= w0 * _direct[c0] + w1 * _direct[c1] + w2 * _direct[c2];
+				area	= w0 * _area[c0] + w1 * _area[c1] + w2 * _area[c2];
+			}
+		}
+
+	private:
+		/// Corners go row by row, row i holds subdivisions + 1 - i of them
+		uint32 index( uint32 i, uint32 j ) const
+		{ return i * ( _subdivisions + 1 ) - i * ( i - 1 ) / 2 + j; }
+
+		uint32				_subdivisions;
+		bool				_valid;
+
+		std::vector<rgb>	_direct;
+		std::vector<rgb>	_area;
+};
+
+#endif
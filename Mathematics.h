@@ -2,8 +2,13 @@
 #define __MAfloatHEMAfloatICS_H__
 
 #include <limits>
+#include <cmath>
 #include "GeneralDefines.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 struct vector3
 {
 	public:
@@ -559,6 +564,154 @@ namespace math
 	inline bool betweenNInc( float x, float a, float b )
 	{ return x > a && x < b; }
 
+	/// Integer power by squaring
+	inline float powi( float x, uint32 n )
+	{
+		float result = 1.0f;
+		while ( n )
+		{
+			if ( n & 1 )
+				result *= x;
+
+			x *= x;
+			n >>= 1;
+		}
+		return result;
+	}
+
+	/// Base 2 logarithm approximation
+	/**
+		Splits x into exponent and mantissa m in [1, 2) and approximates log2(m) = (m - 1) * p(m)
+		with a 5th degree polynomial. The absolute error is below 8.5e-6 for x in [0.5, 2), further away
+		the rounding of the result adds up to |log2(x)| * 6e-8.
+	*/
+	inline float fastLog2( float x )
+	{
+		union { float f; uint32 i; } bits;
+		bits.f = x;
+
+		const float exponent = static_cast<float>( static_cast<int32>( (bits.i >> 23) & 0xff ) - 127 );
+
+		bits.i = (bits.i & 0x007fffff) | 0x3f800000;
+		const float m = bits.f;
+
+		float p = -0.03382204596924061f;
+		p = p * m + 0.31358132554563706f;
+		p = p * m - 1.2177428522256732f;
+		p = p * m + 2.5786199422394427f;
+		p = p * m - 3.3095851728140113f;
+		p = p * m + 3.111630271288995f;
+
+		return exponent + (m - 1.0f) * p;
+	}
+
+	/// Base 2 exponential approximation
+	/**
+		Splits x into integer part, which goes directly to the exponent bits, and fraction f in [0, 1)
+		with 2^f approximated by a 5th degree polynomial. The relative error is below 1.8e-7 including
+		float rounding, x is clamped to [-126, 128).
+	*/
+	inline float fastExp2( float x )
+	{
+		x = std::min( std::max( x, -126.0f ), 127.999f );
+
+		const float whole = floor( x );
+		const float f = x - whole;
+
+		float p = 0.0018937540581920975f;
+		p = p * f + 0.00894959042337237f;
+		p = p * f + 0.05586033707720827f;
+		p = p * f + 0.24014181820146044f;
+		p = p * f + 0.6931544896632286f;
+		p = p * f + 0.9999998983500245f;
+
+		union { float f; uint32 i; } bits;
+		bits.i = static_cast<uint32>( static_cast<int32>( whole ) + 127 ) << 23;
+
+		return bits.f * p;
+	}
+
+	/// Power approximation for a positive base
+	/**
+		exp2( e * log2(x) ), the relative error stays below e * 6.5e-6 + 1.8e-7 for x in [1e-4, 2) while
+		the result is a normal float, it grows with |log2(x)| for smaller bases. Non-positive bases
+		return 0.
+	*/
+	inline float fastPow( float x, float e )
+	{
+		if ( x <= 0.0f )
+			return 0.0f;
+
+		return fastExp2( e * fastLog2( x ) );
+	}
+
+#ifdef __AVX2__
+	/// 8-wide versions of the approximations above, with the same error bounds
+	namespace simd
+	{
+		inline __m256 fastLog2( __m256 x )
+		{
+			const __m256i bits = _mm256_castps_si256( x );
+
+			const __m256 exponent = _mm256_cvtepi32_ps( _mm256_sub_epi32( _mm256_and_si256( _mm256_srli_epi32( bits, 23 ), _mm256_set1_epi32( 0xff ) ), _mm256_set1_epi32( 127 ) ) );
+			const __m256 m = _mm256_castsi256_ps( _mm256_or_si256( _mm256_and_si256( bits, _mm256_set1_epi32( 0x007fffff ) ), _mm256_set1_epi32( 0x3f800000 ) ) );
+
+			__m256 p = _mm256_set1_ps( -0.03382204596924061f );
+			p = _mm256_add_ps( _mm256_mul_ps( p, m ), _mm256_set1_ps( 0.31358132554563706f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, m ), _mm256_set1_ps( -1.2177428522256732f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, m ), _mm256_set1_ps( 2.5786199422394427f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, m ), _mm256_set1_ps( -3.3095851728140113f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, m ), _mm256_set1_ps( 3.111630271288995f ) );
+
+			return _mm256_add_ps( exponent, _mm256_mul_ps( _mm256_sub_ps( m, _mm256_set1_ps( 1.0f ) ), p ) );
+		}
+
+		inline __m256 fastExp2( __m256 x )
+		{
+			x = _mm256_min_ps( _mm256_max_ps( x, _mm256_set1_ps( -126.0f ) ), _mm256_set1_ps( 127.999f ) );
+
+			const __m256 whole = _mm256_floor_ps( x );
+			const __m256 f = _mm256_sub_ps( x, whole );
+
+			__m256 p = _mm256_set1_ps( 0.0018937540581920975f );
+			p = _mm256_add_ps( _mm256_mul_ps( p, f ), _mm256_set1_ps( 0.00894959042337237f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, f ), _mm256_set1_ps( 0.05586033707720827f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, f ), _mm256_set1_ps( 0.24014181820146044f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, f ), _mm256_set1_ps( 0.6931544896632286f ) );
+			p = _mm256_add_ps( _mm256_mul_ps( p, f ), _mm256_set1_ps( 0.9999998983500245f ) );
+
+			const __m256i exponent = _mm256_slli_epi32( _mm256_add_epi32( _mm256_cvtps_epi32( whole ), _mm256_set1_epi32( 127 ) ), 23 );
+
+			return _mm256_mul_ps( _mm256_castsi256_ps( exponent ), p );
+		}
+
+		/// Integer power by squaring, every lane has its own exponent
+		inline __m256 powi( __m256 x, __m256i n )
+		{
+			const __m256i one = _mm256_set1_epi32( 1 );
+			__m256 result = _mm256_set1_ps( 1.0f );
+
+			while ( !_mm256_testz_si256( n, n ) )
+			{
+				const __m256 odd = _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_and_si256( n, one ), one ) );
+				result = _mm256_blendv_ps( result, _mm256_mul_ps( result, x ), odd );
+
+				x = _mm256_mul_ps( x, x );
+				n = _mm256_srli_epi32( n, 1 );
+			}
+			return result;
+		}
+
+		/// Non-positive bases return 0
+		inline __m256 fastPow( __m256 x, __m256 e )
+		{
+			const __m256 positive = _mm256_cmp_ps( x, _mm256_setzero_ps(), _CMP_GT_OQ );
+
+			return _mm256_and_ps( positive, fastExp2( _mm256_mul_ps( e, fastLog2( x ) ) ) );
+		}
+	} // NAMESPACE SIMD
+#endif
+
 	namespace vec
 	{
 	
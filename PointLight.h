@@ -18,6 +18,12 @@ class PointLight
 		rgb getColor() const
 		{ return _color; }
 
+		void setPosition( vector3 const& position )
+		{ _position = position; }
+
+		void setColor( rgb const& color )
+		{ _color = color; }
+
 	private:
 		vector3	_position;
 		rgb		_color;
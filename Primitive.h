@@ -7,14 +7,41 @@
 class Primitive
 {
 	public:
-		Primitive() : _emissiveMaterial(NULL)
+		Primitive() : _emissiveMaterial(NULL), _id(NO_PRIMITIVE), _materialClass(MATERIAL_GENERIC)
+		{}
+
+		virtual ~Primitive()
 		{}
 
 		virtual bool intersect( Ray* ray, HitInfo* hitInfo = NULL ) const
 		{ return false; }
 
+		/// Surface normal at a point of the primitive
+		virtual vector3 normalAt( vector3 const& point ) const
+		{ return vector3(); }
+
+		/// Checks whether a light at a point can reach the front side of the primitive
+		virtual bool canBeLitFrom( vector3 const& point ) const
+		{ return true; }
+
+		/// Axis aligned bounding box
+		/**
+			@param lower[out] minimal corner
+			@param upper[out] maximal corner
+		*/
+		virtual void getBounds( vector3& lower, vector3& upper ) const
+		{
+			const float infinity = std::numeric_limits<float>::max();
+
+			lower = vector3( -infinity, -infinity, -infinity );
+			upper = vector3( infinity, infinity, infinity );
+		}
+
 		void setMaterial( material const& m )
-		{ _material = m; }
+		{ 
+			_material = m; 
+			_materialClass = MATERIAL_GENERIC;
+		}
 
 		void setEmissiveMaterial( emissiveMaterial* em )
 		{ _emissiveMaterial = em; }
@@ -25,9 +52,29 @@ class Primitive
 		emissiveMaterial* getEmissiveMaterial() const
 		{ return _emissiveMaterial; }
 
+		/// Primitives with an emissive material are area light patches
+		bool isLight() const
+		{ return _emissiveMaterial != NULL; }
+
+		/// Index of the primitive inside the scene, assigned by RayTracer::addPrimitive
+		void setId( uint32 id )
+		{ _id = id; }
+
+		uint32 getId() const
+		{ return _id; }
+
+		/// Material class selecting the shading kernel, assigned by RayTracer::prepareScene
+		void setMaterialClass( uint32 materialClass )
+		{ _materialClass = materialClass; }
+
+		uint32 getMaterialClass() const
+		{ return _materialClass; }
+
 	private:
 		material _material;
 		emissiveMaterial* _emissiveMaterial;
+		uint32 _id;
+		uint32 _materialClass;
 };
 
 class Triangle : public Primitive
@@ -140,6 +187,36 @@ class Triangle : public Primitive
 		{
 			return _normal;
 		}
+
+		vector3 normalAt( vector3 const& point ) const
+		{ return _normal; }
+
+		/// Triangles are shaded on the side of their normal only
+		bool canBeLitFrom( vector3 const& point ) const
+		{ return math::vec::scalarProduct( _normal, point - _a ) > 0.0f; }
+
+		/// Barycentric coordinates of a point of the plane, point = a + u * edge1 + v * edge2
+		void barycentric( vector3 const& point, float& u, float& v ) const
+		{
+			const vector3 d = point - _a;
+
+			const float d00 = math::vec::scalarProduct( _edge1, _edge1 );
+			const float d01 = math::vec::scalarProduct( _edge1, _edge2 );
+			const float d11 = math::vec::scalarProduct( _edge2, _edge2 );
+			const float d20 = math::vec::scalarProduct( d, _edge1 );
+			const float d21 = math::vec::scalarProduct( d, _edge2 );
+
+			const float inverse = 1.0f / ( d00 * d11 - d01 * d01 );
+
+			u = ( d11 * d20 - d01 * d21 ) * inverse;
+			v = ( d00 * d21 - d01 * d20 ) * inverse;
+		}
+
+		void getBounds( vector3& lower, vector3& upper ) const
+		{
+			lower = vector3( std::min( _a.x(), std::min( _b.x(), _c.x() ) ), std::min( _a.y(), std::min( _b.y(), _c.y() ) ), std::min( _a.z(), std::min( _b.z(), _c.z() ) ) );
+			upper = vector3( std::max( _a.x(), std::max( _b.x(), _c.x() ) ), std::max( _a.y(), std::max( _b.y(), _c.y() ) ), std::max( _a.z(), std::max( _b.z(), _c.z() ) ) );
+		}
 	
 	private:
 		vector3 _a, _b, _c;
@@ -191,6 +268,17 @@ class Sphere : public Primitive
 			return false;
 		}	
 
+		vector3 normalAt( vector3 const& point ) const
+		{ return ( point - _center ).normalize(); }
+
+		void getBounds( vector3& lower, vector3& upper ) const
+		{
+			const vector3 extent( _radius, _radius, _radius );
+
+			lower = _center - extent;
+			upper = _center + extent;
+		}
+
 	private:
 		vector3 _center;
 		float _radius;
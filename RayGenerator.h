@@ -0,0 +1,147 @@
+#ifndef __RAY_GENERATOR_H__
+#define __RAY_GENERATOR_H__
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+const uint32 RAY_PACKET_SIZE = 8;
+
+/// Primary rays of neighbouring pixels in a SoA layout
+struct rayPacket
+{
+	public:
+		Ray ray( uint32 i ) const
+		{ return Ray( vector3( ox[i], oy[i], oz[i] ), vector3( dx[i], dy[i], dz[i] ) ); }
+
+		float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+		float dx[RAY_PACKET_SIZE], dy[RAY_PACKET_SIZE], dz[RAY_PACKET_SIZE];
+};
+
+/// Camera ray generator
+/**
+	A primary ray goes from the point on the near plane to the point on the far plane of a pixel, both
+	unprojected by the inverse MVP matrix. In homogeneous coordinates the unprojected points are linear
+	in the pixel coordinates, so instead of transforming two points per pixel we transform the corner
+	of the viewport and one pixel step along x and y once per frame:
+
+		near(x, y) = near0 + x * nearDx + y * nearDy
+
+	and similarly for the far plane. A ray then costs a few additions, two divisions by w and a normalization.
+*/
+class RayGenerator
+{
+	public:
+		RayGenerator()
+		{ }
+
+		/// Derives the per-frame increments
+		/**
+			@param inverseMVP[in] inverse of the model-view-projection matrix
+			@param vp[in] viewport, pixel coordinates are relative to its offset and normalized by its size
+		*/
+		void setup( matrix4x4 const& inverseMVP, viewport const& vp )
+		{
+			const float stepX = 2.0f / static_cast<float>( vp.width() );
+			const float stepY = 2.0f / static_cast<float>( vp.height() );
+
+			// pixel [0, 0] of the buffer, the viewport starts at its offset like in the rasterizer
+			const float x0 = -1.0f - stepX * static_cast<float>( vp.offsetX() );
+			const float y0 = -1.0f - stepY * static_cast<float>( vp.offsetY() );
+
+			_near0	= vertex( x0, y0, -1.0f, 1.0f );
+			_far0	= vertex( x0, y0, 1.0f, 1.0f );
+			_dx		= vertex( stepX, 0.0f, 0.0f, 0.0f );
+			_dy		= vertex( 0.0f, stepY, 0.0f, 0.0f );
+
+			_near0	*= inverseMVP;
+			_far0	*= inverseMVP;
+			// a pixel step moves the near and the far point by the same homogeneous vector
+			_dx		*= inverseMVP;
+			_dy		*= inverseMVP;
+		}
+
+		/// Generates the primary ray of a pixel
+		/**
+			@param x[in] X coord, may be fractional
+			@param y[in] Y coord, may be fractional
+			@return Ray
+		*/
+		Ray generate( float x, float y ) const
+		{
+			const float nx = _near0.x() + x * _dx.x() + y * _dy.x(), fx = _far0.x() + x * _dx.x() + y * _dy.x();
+			const float ny = _near0.y() + x * _dx.y() + y * _dy.y(), fy = _far0.y() + x * _dx.y() + y * _dy.y();
+			const float nz = _near0.z() + x * _dx.z() + y * _dy.z(), fz = _far0.z() + x * _dx.z() + y * _dy.z();
+			const float nw = _near0.w() + x * _dx.w() + y * _dy.w(), fw = _far0.w() + x * _dx.w() + y * _dy.w();
+
+			const float invNw = 1.0f / nw;
+			const float invFw = 1.0f / fw;
+
+			const vector3 origin( nx * invNw, ny * invNw, nz * invNw );
+			vector3 direction( fx * invFw - origin.x(), fy * invFw - origin.y(), fz * invFw - origin.z() );
+
+			return Ray( origin, direction.normalize() );
+		}
+
+		/// Generates primary rays of up to RAY_PACKET_SIZE consecutive pixels of a row
+		/**
+			With AVX all the rays of the packet are generated at once.
+
+			@param x[in] X coord of the first pixel
+			@param y[in] Y coord of the row
+			@param packet[out] rays of pixels [x, y] .. [x + RAY_PACKET_SIZE - 1, y]
+		*/
+		void generatePacket( uint32 x, uint32 y, rayPacket& packet ) const
+		{
+			const float fy = static_cast<float>( y );
+
+#ifdef __AVX__
+			const __m256 px = _mm256_add_ps( _mm256_set1_ps( static_cast<float>( x ) ), _mm256_set_ps( 7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f ) );
+			const __m256 one = _mm256_set1_ps( 1.0f );
+
+			// row start + x * step
+			#define SGL_ROW_LANES( base, c ) _mm256_add_ps( _mm256_set1_ps( base.c() + fy * _dy.c() ), _mm256_mul_ps( px, _mm256_set1_ps( _dx.c() ) ) )
+
+			const __m256 invNw = _mm256_div_ps( one, SGL_ROW_LANES( _near0, w ) );
+			const __m256 invFw = _mm256_div_ps( one, SGL_ROW_LANES( _far0, w ) );
+
+			const __m256 ox = _mm256_mul_ps( SGL_ROW_LANES( _near0, x ), invNw );
+			const __m256 oy = _mm256_mul_ps( SGL_ROW_LANES( _near0, y ), invNw );
+			const __m256 oz = _mm256_mul_ps( SGL_ROW_LANES( _near0, z ), invNw );
+
+			__m256 dx = _mm256_sub_ps( _mm256_mul_ps( SGL_ROW_LANES( _far0, x ), invFw ), ox );
+			__m256 dy = _mm256_sub_ps( _mm256_mul_ps( SGL_ROW_LANES( _far0, y ), invFw ), oy );
+			__m256 dz = _mm256_sub_ps( _mm256_mul_ps( SGL_ROW_LANES( _far0, z ), invFw ), oz );
+
+			#undef SGL_ROW_LANES
+
+			const __m256 length = _mm256_sqrt_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( dx, dx ), _mm256_mul_ps( dy, dy ) ), _mm256_mul_ps( dz, dz ) ) );
+			const __m256 invLength = _mm256_div_ps( one, length );
+
+			_mm256_storeu_ps( packet.ox, ox );
+			_mm256_storeu_ps( packet.oy, oy );
+			_mm256_storeu_ps( packet.oz, oz );
+			_mm256_storeu_ps( packet.dx, _mm256_mul_ps( dx, invLength ) );
+			_mm256_storeu_ps( packet.dy, _mm256_mul_ps( dy, invLength ) );
+			_mm256_storeu_ps( packet.dz, _mm256_mul_ps( dz, invLength ) );
+#else
+			for ( uint32 i = 0; i < RAY_PACKET_SIZE; ++i )
+			{
+				Ray ray = generate( static_cast<float>( x + i ), fy );
+
+				packet.ox[i] = ray.getOrigin().x();
+				packet.oy[i] = ray.getOrigin().y();
+				packet.oz[i] = ray.getOrigin().z();
+				packet.dx[i] = ray.getDirection().x();
+				packet.dy[i] = ray.getDirection().y();
+				packet.dz[i] = ray.getDirection().z();
+			}
+#endif
+		}
+
+	private:
+		vertex	_near0, _far0;	///< unprojected corner [0, 0] of the viewport
+		vertex	_dx, _dy;		///< unprojected pixel steps
+};
+
+#endif
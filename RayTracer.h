@@ -23,358 +23,2106 @@ class RayTracer
 	public:	
 		RayTracer( Context* context = NULL ) : _context(context)
 		{ 
-			srand(time(NULL));
 			_emBg = NULL;
+			_emBgHash = 0;
+			_lightSamples = 0;
+			_useIrradianceCache = false;
+			_fastShading = false;
+			_areaLightSamples = AREA_LIGHT_SAMPLES;
+			_pathRecorder = NULL;
+			_pathWeight = 1.0f;
+			_useBakedLighting = false;
+			_frame = 0;
+			_random.resize( threadCount() );
+			_scene = new Scene();
 		}
 
+		~RayTracer()
+		{ _scene->release(); }
+
+		/// Renders another scene, which is shared with the ray tracers already rendering it
+		/**
+			The previous scene is released. The render modes of this ray tracer are kept, the state which
+			belongs to the previous scene is dropped.
+		*/
+		void attachScene( Scene* scene )
+		{
+			scene->retain();
+			_scene->release();
+			_scene = scene;
+
+			_shadowHints.clear();
+			_occluderCache.clear();
+		}
+
+		Scene* getScene()
+		{ return _scene; }
+
+		/// Hash of the geometry and materials, fed by the context as they are added
+		ContentHash& getSceneHash()
+		{ return _scene->hash; }
+
 		void addLight( PointLight*  light )
 		{
-			// TODO: There might be more light types in the future, atm leave
-			// just PointLight, because inheritance is a pretty large overhead
-			
-			_lights.push_back( light );
+			// TODO: There might be more light types in the future, atm leave
+			// just PointLight, because inheritance is a pretty large overhead
+			
+			_scene->lights.push_back( light );
+			invalidateCaches();
+
+			const vector3 position = light->getPosition();
+			invalidateLightmaps( &position, 1 );
+		}
+
+		void addPrimitive( Primitive* primitive )
+		{
+			primitive->setId( _scene->primitives.size() );
+			_scene->primitives.push_back( primitive );
+			invalidateCaches();
+			invalidateOccludedLightmaps( primitive );
+		}
+
+		/// Casts a ray at an [x, y] coordinate
+		/**
+			Casts a ray at an [x, y] coordinate in viewport space.
+
+			@param		x[in] X coord
+			@param		y[in] Y coord
+			@param		surface[out] optional, surface seen through the pixel
+			@return		color of the reflection
+		*/
+		const rgb castRay( uint32 x, uint32 y, surfaceSample* surface = NULL )
+		{					
+			return castRay( &generateRay(x, y), surface );		
+		}
+
+		/// Casts an already generated primary ray
+		/**
+			@param		ray[in] primary ray, see generatePacket
+			@param		surface[out] optional, surface seen through the pixel
+			@return		color of the reflection
+		*/
+		const rgb castRay( Ray* ray, surfaceSample* surface = NULL )
+		{
+			HitInfo hitInfo;
+			rgb sampled;
+			const rgb color = intersectRayWithScene( ray, &hitInfo, surface ? &sampled : NULL );
+
+			if ( surface )
+			{
+				describeSurface( &hitInfo, *surface );
+				surface->sampled = sampled;
+			}
+
+			return color;
+		}
+
+		/// Surface of a primary hit, the guide of the denoiser
+		/**
+			@param		hitInfo[in] primary hit
+			@param		surface[out] surface, the background when nothing was hit
+		*/
+		static void describeSurface( HitInfo* hitInfo, surfaceSample& surface )
+		{
+			surface = surfaceSample();
+
+			if ( Primitive* primitive = hitInfo->getPrimitive() )
+			{
+				surface.normal		= hitInfo->getNormal();
+				surface.depth		= hitInfo->getDistance();
+				surface.albedo		= primitive->isLight() ? WHITE : primitive->getMaterial().color() * primitive->getMaterial().diffuse();
+				surface.primitiveId	= primitive->getId();
+			}
+		}
+
+		/// Casts a primary ray with direct light only
+		/**
+			The first stage of the deadline render, secondary rays are added by castSecondary.
+
+			@param		ray[in] primary ray
+			@param		hitInfo[out] primary hit
+			@param		area[out] area light contribution, refined later with more samples
+			@return		color
+		*/
+		rgb castDirect( Ray* ray, HitInfo* hitInfo, rgb* area )
+		{
+			*area = rgb();
+
+			findClosestHit( ray, hitInfo );
+
+			Primitive* primitive = hitInfo->getPrimitive();
+
+			if ( !primitive )
+				return missColor( ray );
+
+			if ( primitive->isLight() )
+				return primitive->getEmissiveMaterial()->color();
+
+			if ( _lightSamples )
+				return shadeSampledLights<MATERIAL_GENERIC>( ray, hitInfo );
+
+			rgb color = shade<MATERIAL_GENERIC>( ray, hitInfo );
+
+			*area = shadeAreaLight( ray, hitInfo );
+			color += *area;
+
+			return color;
+		}
+
+		/// Reflected and refracted light of a primary hit
+		/**
+			@param		ray[in] primary ray
+			@param		hitInfo[in] primary hit, see castDirect
+			@return		color
+		*/
+		rgb castSecondary( Ray* ray, HitInfo* hitInfo )
+		{
+			Primitive* primitive = hitInfo->getPrimitive();
+
+			if ( !primitive || primitive->isLight() )
+				return rgb();
+
+			rgb color = castReflectedRays( ray, hitInfo );
+			color += castRefractedRays( ray, hitInfo );
+
+			return color;
+		}
+
+		/// Casts the primary rays of a packet
+		/**
+			Point lights are evaluated for all the hits of the packet at once, see shadowRays, occludedPacket
+			and shadePacket. Area lights, reflection and refraction are still shaded per hit, as are all the
+			hits when lights are sampled or shadow hints are set, and hits whose diffuse light is baked.
+
+			@param		packet[in] primary rays, see generatePacket
+			@param		count[in] number of valid rays in the packet
+			@param		colors[out] color of every ray
+			@param		surfaces[out] optional, surface seen by every ray
+		*/
+		void castPacket( rayPacket const& packet, uint32 count, rgb* colors, surfaceSample* surfaces = NULL )
+		{
+			Ray			rays[RAY_PACKET_SIZE];
+			HitInfo		hitInfos[RAY_PACKET_SIZE];
+			hitPacket	hits;
+
+			for ( uint32 i = 0; i < count; ++i )
+			{
+				rays[i] = packet.ray( i );
+				findClosestHit( &rays[i], &hitInfos[i] );
+
+				Primitive* primitive = hitInfos[i].getPrimitive();
+
+				if ( surfaces )
+					describeSurface( &hitInfos[i], surfaces[i] );
+
+				if ( !primitive )
+					colors[i] = missColor( &rays[i] );
+				else if ( primitive->isLight() )
+					colors[i] = primitive->getEmissiveMaterial()->color();
+				else if ( _lightSamples || !_shadowHints.empty() || hasBakedDiffuse( primitive ) )
+					colors[i] = shadeClassified( &rays[i], &hitInfos[i], surfaces ? &surfaces[i].sampled : NULL );
+				else
+				{
+					const vector3 hitPoint = rays[i].getOrigin() + ( rays[i].getDirection() * hitInfos[i].getDistance() );
+					hits.set( i, hitPoint, hitInfos[i].getNormal(), rays[i].getDirection(), primitive->getId(), primitive->getMaterial() );
+				}
+			}
+
+			if ( !hits.mask )
+				return;
+
+			float r[RAY_PACKET_SIZE] = { 0.0f }, g[RAY_PACKET_SIZE] = { 0.0f }, b[RAY_PACKET_SIZE] = { 0.0f };
+
+			for ( uint32 l = 0; l < _scene->lights.size(); ++l )
+			{
+				shadowPacket shadows;
+				shadowRays( hits, l, shadows );
+
+				const uint32 lit = shadows.mask & ~occludedPacket( shadows, l );
+				if ( lit )
+					shadePacket( hits, shadows, l, lit, r, g, b );
+			}
+
+			for ( uint32 i = 0; i < count; ++i )
+			{
+				if ( !( hits.mask & (1u << i) ) )
+					continue;
+
+				colors[i] = rgb( r[i], g[i], b[i] );
+
+				const rgb area = shadeAreaLight( &rays[i], &hitInfos[i] );
+				if ( surfaces )
+					surfaces[i].sampled = area;
+
+				colors[i] += area;
+				colors[i] += castReflectedRays( &rays[i], &hitInfos[i] );
+				colors[i] += castRefractedRays( &rays[i], &hitInfos[i] );
+			}
+		}
+
+		/// Shadow rays of a hit packet towards a point light
+		/**
+			Same rays as pointLightRay, only lanes whose surface faces the light are marked in the mask.
+
+			@param		hits[in] hit packet
+			@param		lightIndex[in] index of the point light
+			@param		shadows[out] shadow rays
+		*/
+		void shadowRays( hitPacket const& hits, uint32 lightIndex, shadowPacket& shadows ) const
+		{
+			const vector3 lightPos = _scene->lights[lightIndex]->getPosition();
+
+#ifdef __AVX__
+			const __m256 dx = _mm256_sub_ps( _mm256_loadu_ps( hits.px ), _mm256_set1_ps( lightPos.x() ) );
+			const __m256 dy = _mm256_sub_ps( _mm256_loadu_ps( hits.py ), _mm256_set1_ps( lightPos.y() ) );
+			const __m256 dz = _mm256_sub_ps( _mm256_loadu_ps( hits.pz ), _mm256_set1_ps( lightPos.z() ) );
+
+			const __m256 length = _mm256_sqrt_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( dx, dx ), _mm256_mul_ps( dy, dy ) ), _mm256_mul_ps( dz, dz ) ) );
+
+			const __m256 ldx = _mm256_div_ps( dx, length );
+			const __m256 ldy = _mm256_div_ps( dy, length );
+			const __m256 ldz = _mm256_div_ps( dz, length );
+
+			_mm256_storeu_ps( shadows.rays.ox, _mm256_set1_ps( lightPos.x() ) );
+			_mm256_storeu_ps( shadows.rays.oy, _mm256_set1_ps( lightPos.y() ) );
+			_mm256_storeu_ps( shadows.rays.oz, _mm256_set1_ps( lightPos.z() ) );
+			_mm256_storeu_ps( shadows.rays.dx, ldx );
+			_mm256_storeu_ps( shadows.rays.dy, ldy );
+			_mm256_storeu_ps( shadows.rays.dz, ldz );
+			_mm256_storeu_ps( shadows.tmax, _mm256_sub_ps( length, _mm256_set1_ps( EPSILON ) ) );
+
+			// the light direction is the opposite of the shadow ray direction
+			const __m256 facing = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_loadu_ps( hits.nx ), ldx ), _mm256_mul_ps( _mm256_loadu_ps( hits.ny ), ldy ) ), _mm256_mul_ps( _mm256_loadu_ps( hits.nz ), ldz ) );
+
+			shadows.mask = hits.mask & static_cast<uint32>( _mm256_movemask_ps( _mm256_cmp_ps( facing, _mm256_setzero_ps(), _CMP_LT_OQ ) ) );
+#else
+			shadows.mask = 0;
+
+			for ( uint32 i = 0; i < RAY_PACKET_SIZE; ++i )
+			{
+				if ( !( hits.mask & (1u << i) ) )
+					continue;
+
+				const vector3 hitPoint( hits.px[i], hits.py[i], hits.pz[i] );
+				const Ray lightRay = pointLightRay( lightPos, hitPoint );
+
+				shadows.rays.ox[i] = lightPos.x();	shadows.rays.dx[i] = lightRay.getDirection().x();
+				shadows.rays.oy[i] = lightPos.y();	shadows.rays.dy[i] = lightRay.getDirection().y();
+				shadows.rays.oz[i] = lightPos.z();	shadows.rays.dz[i] = lightRay.getDirection().z();
+				shadows.tmax[i] = lightRay.tmax();
+
+				if ( math::vec::scalarProduct( vector3( hits.nx[i], hits.ny[i], hits.nz[i] ), lightRay.getDirection() ) < 0.0f )
+					shadows.mask |= 1u << i;
+			}
+#endif
+		}
+
+		/// Occlusion test of a packet of shadow rays
+		/**
+			@param		shadows[in] shadow rays, only the lanes in the mask are tested
+			@param		lightSlot[in] occluder cache slot of the light
+			@return		bit per occluded lane
+		*/
+		uint32 occludedPacket( shadowPacket const& shadows, uint32 lightSlot )
+		{
+			uint32 occluded = 0;
+
+			for ( uint32 i = 0; i < RAY_PACKET_SIZE; ++i )
+			{
+				if ( !( shadows.mask & (1u << i) ) )
+					continue;
+
+				Ray lightRay = shadows.ray( i );
+				if ( isInShadow( &lightRay, NO_PRIMITIVE, lightSlot ) )
+					occluded |= 1u << i;
+			}
+			return occluded;
+		}
+
+		/// Phong shader of a hit packet for a single light
+		/**
+			Evaluates the same terms as shade for all the lanes at once. The highlight is added to lanes with
+			shine > 0 and ks > 0. In the fast shading mode with AVX2 the exponent is vectorized with the same
+			dispatch as specularPower, so the lanes match the hits shaded one by one.
+
+			@param		hits[in] hit packet
+			@param		shadows[in] shadow rays of the light, see shadowRays
+			@param		lightIndex[in] index of the point light
+			@param		lit[in] bit per lane reached by the light
+			@param		r[in, out] red, the contribution of the light is added
+			@param		g[in, out] green
+			@param		b[in, out] blue
+		*/
+		void shadePacket( hitPacket const& hits, shadowPacket const& shadows, uint32 lightIndex, uint32 lit, float* r, float* g, float* b ) const
+		{
+			const rgb lightColor = _scene->lights[lightIndex]->getColor();
+
+#ifdef __AVX__
+			const __m256 zero = _mm256_setzero_ps();
+
+			const __m256 nx = _mm256_loadu_ps( hits.nx ), ny = _mm256_loadu_ps( hits.ny ), nz = _mm256_loadu_ps( hits.nz );
+
+			// direction towards the light
+			const __m256 sx = _mm256_sub_ps( zero, _mm256_loadu_ps( shadows.rays.dx ) );
+			const __m256 sy = _mm256_sub_ps( zero, _mm256_loadu_ps( shadows.rays.dy ) );
+			const __m256 sz = _mm256_sub_ps( zero, _mm256_loadu_ps( shadows.rays.dz ) );
+
+			const __m256 intensity = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( nx, sx ), _mm256_mul_ps( ny, sy ) ), _mm256_mul_ps( nz, sz ) );
+
+			// specular
+			const __m256 twice = _mm256_mul_ps( _mm256_set1_ps( 2.0f ), intensity );
+			const __m256 rx = _mm256_sub_ps( sx, _mm256_mul_ps( twice, nx ) );
+			const __m256 ry = _mm256_sub_ps( sy, _mm256_mul_ps( twice, ny ) );
+			const __m256 rz = _mm256_sub_ps( sz, _mm256_mul_ps( twice, nz ) );
+
+			__m256 cosine = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( rx, _mm256_loadu_ps( hits.vx ) ), _mm256_mul_ps( ry, _mm256_loadu_ps( hits.vy ) ) ), _mm256_mul_ps( rz, _mm256_loadu_ps( hits.vz ) ) );
+
+			const __m256 shine = _mm256_loadu_ps( hits.shine );
+			const __m256 ks = _mm256_loadu_ps( hits.ks );
+
+#ifdef __AVX2__
+			if ( _fastShading )
+			{
+				// the dispatch of specularPower: integer exponents by squaring, the others approximated
+				const __m256i n = _mm256_cvttps_epi32( shine );
+				const __m256 integer = _mm256_and_ps( _mm256_cmp_ps( _mm256_cvtepi32_ps( n ), shine, _CMP_EQ_OQ ),
+													  _mm256_cmp_ps( shine, _mm256_set1_ps( static_cast<float>( MAX_SQUARING_SHINE ) ), _CMP_LE_OQ ) );
+
+				const __m256 squared = math::simd::powi( cosine, _mm256_and_si256( n, _mm256_castps_si256( integer ) ) );
+				cosine = _mm256_blendv_ps( math::simd::fastPow( cosine, shine ), squared, integer );
+			}
+			else
+#endif
+			{
+				float cosines[RAY_PACKET_SIZE];
+				_mm256_storeu_ps( cosines, cosine );
+
+				for ( uint32 i = 0; i < RAY_PACKET_SIZE; ++i )
+					if ( lit & (1u << i) )
+						cosines[i] = _fastShading ? specularPower( cosines[i], hits.shine[i] ) : pow( cosines[i], hits.shine[i] );
+
+				cosine = _mm256_loadu_ps( cosines );
+			}
+			// NaN lanes stay NaN, as with std::min
+			cosine = _mm256_min_ps( _mm256_set1_ps( 10000.0f ), cosine );
+
+			const __m256 highlight = _mm256_and_ps( _mm256_cmp_ps( shine, zero, _CMP_GT_OQ ), _mm256_cmp_ps( ks, zero, _CMP_GT_OQ ) );
+			const __m256 specular = _mm256_and_ps( highlight, _mm256_mul_ps( ks, cosine ) );
+
+			// lanes reached by the light
+			int32 lanes[RAY_PACKET_SIZE];
+			for ( uint32 i = 0; i < RAY_PACKET_SIZE; ++i )
+				lanes[i] = ( lit & (1u << i) ) ? -1 : 0;
+
+			const __m256 active = _mm256_castsi256_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( lanes ) ) );
+
+			// diffuse + specular, added to the lit lanes
+			#define SGL_SHADE_CHANNEL( out, k, c ) \
+				_mm256_storeu_ps( out, _mm256_add_ps( _mm256_loadu_ps( out ), _mm256_and_ps( active, _mm256_add_ps( \
+					_mm256_mul_ps( _mm256_mul_ps( _mm256_loadu_ps( k ), intensity ), _mm256_set1_ps( c ) ), \
+					_mm256_mul_ps( specular, _mm256_set1_ps( c ) ) ) ) ) )
+
+			SGL_SHADE_CHANNEL( r, hits.kr, lightColor.red() );
+			SGL_SHADE_CHANNEL( g, hits.kg, lightColor.green() );
+			SGL_SHADE_CHANNEL( b, hits.kb, lightColor.blue() );
+
+			#undef SGL_SHADE_CHANNEL
+#else
+			for ( uint32 i = 0; i < RAY_PACKET_SIZE; ++i )
+			{
+				if ( !( lit & (1u << i) ) )
+					continue;
+
+				const vector3 hitNormal( hits.nx[i], hits.ny[i], hits.nz[i] );
+				const vector3 shadowDir( -shadows.rays.dx[i], -shadows.rays.dy[i], -shadows.rays.dz[i] );
+
+				const float intensity = math::vec::scalarProduct( hitNormal, shadowDir );
+
+				rgb color = rgb( hits.kr[i], hits.kg[i], hits.kb[i] ) * intensity * lightColor;
+
+				if ( hits.shine[i] > 0.0f && hits.ks[i] > 0.0f )
+				{
+					const vector3 shineDir = shadowDir - ( 2.0f * intensity * hitNormal );
+					float cosine = math::vec::scalarProduct( shineDir, vector3( hits.vx[i], hits.vy[i], hits.vz[i] ) );
+					cosine = _fastShading ? specularPower( cosine, hits.shine[i] ) : pow( cosine, hits.shine[i] );
+					cosine = std::min( cosine, 10000.0f );
+
+					color += hits.ks[i] * cosine * lightColor;
+				}
+
+				r[i] += color.red();
+				g[i] += color.green();
+				b[i] += color.blue();
+			}
+#endif
+		}
+
+		/// Generates a ray for an [x, y] coordinate
+		/**
+			Based on given [x, y] coordinates, it returns a ray. Therefore we need to set ray origin (0, 0, 0) and 
+			a direction inverse-transformation-matrix * x-y-vector. The transformation is done incrementally by
+			RayGenerator, see its documentation.
+
+			@param		x[in] X coord
+			@param		y[in] Y coord
+			@return		Ray
+		*/
+		Ray generateRay( uint32 x, uint32 y )
+		{			
+			return _rayGenerator.generate( static_cast<float>(x), static_cast<float>(y) );
+		}
+
+		/// Generates a ray for a fractional [x, y] coordinate
+		/**
+			@param		x[in] X coord
+			@param		y[in] Y coord
+			@return		Ray
+		*/
+		Ray generateSubpixelRay( float x, float y )
+		{
+			return _rayGenerator.generate( x, y );
+		}
+
+		/// Casts a primary ray whose visible primitive is known
+		/**
+			Only the given primitive is intersected, the hybrid render knows it from the visibility buffer.
+
+			@param		ray[in] primary ray
+			@param		primitiveId[in] primitive seen along the ray, NO_PRIMITIVE for the background
+			@param		color[out] color of the ray
+			@param		surface[out] optional, surface seen through the pixel
+			@return		false when the ray misses the primitive, the caller has to cast the ray against the scene
+		*/
+		bool castVisibleRay( Ray* ray, uint32 primitiveId, rgb& color, surfaceSample* surface = NULL )
+		{
+			HitInfo hitInfo;
+
+			if ( primitiveId != NO_PRIMITIVE )
+			{
+				Primitive* primitive = _scene->primitives[primitiveId];
+
+				if ( !primitive->intersect( ray, &hitInfo ) )
+					return false;
+
+				hitInfo.setPrimitive( primitive );
+			}
+
+			rgb sampled;
+			color = shadeClosestHit( ray, &hitInfo, surface ? &sampled : NULL );
+
+			if ( surface )
+			{
+				describeSurface( &hitInfo, *surface );
+				surface->sampled = sampled;
+			}
+			return true;
+		}
+
+		/// Primitive visible at an [x, y] coordinate
+		/**
+			@param		x[in] X coord
+			@param		y[in] Y coord
+			@return		id of the closest primitive, NO_PRIMITIVE for the background
+		*/
+		uint32 primitiveAt( uint32 x, uint32 y )
+		{
+			Ray ray = generateRay( x, y );
+			HitInfo hitInfo;
+
+			findClosestHit( &ray, &hitInfo );
+
+			return hitInfo.getPrimitive() ? hitInfo.getPrimitive()->getId() : NO_PRIMITIVE;
+		}
+
+		/// Generates rays for RAY_PACKET_SIZE consecutive pixels of a row
+		/**
+			@param		x[in] X coord of the first pixel
+			@param		y[in] Y coord
+			@param		packet[out] rays
+		*/
+		void generatePacket( uint32 x, uint32 y, rayPacket& packet )
+		{
+			_rayGenerator.generatePacket( x, y, packet );
+		}
+
+		/// Intersection of the scene and a ray
+		/**
+			Intersects the ray with all the primitives in the scene. If it hits a primitive, it writes the details
+			inside hitInfo and calculates the color of the reflection based on the Phong model. The color then bubbles up
+			to castRay-renderScene and is written inside the color buffer.
+
+			I case we hit something, we also check the material we hit.
+
+			In case of specular materials, we generate reflective rays/ In case of refractive materials,
+			we generate refractive rays. We only generate rays up until MAX_RAY_DEPTH, to prevent deadlock.
+
+			Area light patches are stored among the other primitives, so the closest hit decides whether
+			we see the light or an object in front of it.
+
+			@param		Ray[in]
+			@param		HitInfo[in]	Info structure to describe the intersection of the ray and the scene
+			@param		sampled[out] optional, the part of the direct light estimated by sampling, see shadeHit
+			@return		rgb
+		*/
+		rgb intersectRayWithScene( Ray* ray, HitInfo* hitInfo, rgb* sampled = NULL )
+		{						
+			if ( ray->getDepth() > MAX_RAY_DEPTH )
+				return rgb();
+
+			findClosestHit( ray, hitInfo );
+
+			return shadeClosestHit( ray, hitInfo, sampled );
+		}
+
+		/// Color of a ray whose closest hit is known
+		/**
+			@param		Ray[in]
+			@param		HitInfo[in] closest hit, see findClosestHit
+			@param		sampled[out] optional, see shadeHit
+			@return		rgb
+		*/
+		rgb shadeClosestHit( Ray* ray, HitInfo* hitInfo, rgb* sampled = NULL )
+		{
+			// we hit something
+			if ( Primitive* primitive = hitInfo->getPrimitive() )
+			{				
+				// emissive area, lights are not shaded
+				if ( primitive->isLight() )
+				{
+					if ( _pathRecorder )
+						recordPathNode( ray, hitInfo, rgb(), rgb() );
+
+					return primitive->getEmissiveMaterial()->color();
+				}
+
+				// shade color
+				return shadeClassified( ray, hitInfo, sampled );
+			}
+
+			if ( _pathRecorder )
+				recordPathNode( ray, hitInfo, rgb(), rgb() );
+			
+			return missColor( ray ); // background
+		}
+
+		/// Records a hit along the path of the traced pixel, see recordPaths
+		void recordPathNode( Ray* ray, HitInfo* hitInfo, rgb const& direct, rgb const& area )
+		{
+			pathNode node;
+
+			node.ray		= *ray;
+			node.hitInfo	= *hitInfo;
+			node.weight		= _pathWeight;
+			node.direct		= direct;
+			node.area		= area;
+
+			_pathRecorder->push_back( node );
+		}
+
+		/// Starts/stops recording the hits of the following castRay calls
+		/**
+			@param nodes[out] recorded hits are appended here, NULL stops the recording
+		*/
+		void recordPaths( std::vector<pathNode>* nodes )
+		{ 
+			_pathRecorder = nodes; 
+			_pathWeight = 1.0f;
+		}
+
+		/// Light a recorded hit receives after light edits
+		/**
+			Misses and lights are looked up again, the background and emissions are cheap. The point light
+			part of other hits is corrected by the edited lights only, the area light part is shaded again
+			when any area light changed. The node is updated to the new lights.
+
+			@param node[in, out] recorded hit
+			@param edits[in] edited point lights along with their state before the edits
+			@param areaLightsEdited[in] whether any area light changed
+			@return light of the hit, not weighted
+		*/
+		rgb relightPathNode( pathNode& node, pointLightEdits const& edits, bool areaLightsEdited )
+		{
+			Primitive* primitive = node.hitInfo.getPrimitive();
+
+			if ( !primitive )
+				return missColor( &node.ray );
+
+			if ( primitive->isLight() )
+				return primitive->getEmissiveMaterial()->color();
+
+			for ( pointLightEdits::const_iterator it = edits.begin(); it != edits.end(); ++it )
+				node.direct += pointLightDelta( &node.ray, &node.hitInfo, it->second, it->first );
+
+			if ( areaLightsEdited )
+				node.area = shadeAreaLight( &node.ray, &node.hitInfo );
+
+			rgb color = node.direct;
+			return color + node.area;
+		}
+
+		/// Shades a hit with the kernel of its material class
+		/**
+			@param		Ray[in]
+			@param		HitInfo[in] hit of a primitive which isn't a light
+			@param		sampled[out] optional, see shadeHit
+			@return		rgb
+		*/
+		rgb shadeClassified( Ray* ray, HitInfo* hitInfo, rgb* sampled = NULL )
+		{
+			// every material class has its own kernel without the branches it doesn't need
+			switch ( hitInfo->getPrimitive()->getMaterialClass() )
+			{
+				case MATERIAL_DIFFUSE:
+					return shadeHit<MATERIAL_DIFFUSE>( ray, hitInfo, sampled );
+				case MATERIAL_HIGHLIGHT:
+					return shadeHit<MATERIAL_HIGHLIGHT>( ray, hitInfo, sampled );
+				case MATERIAL_REFLECTIVE:
+					return shadeHit<MATERIAL_REFLECTIVE>( ray, hitInfo, sampled );
+				case MATERIAL_HIGHLIGHT | MATERIAL_REFLECTIVE:
+					return shadeHit<MATERIAL_HIGHLIGHT | MATERIAL_REFLECTIVE>( ray, hitInfo, sampled );
+				case MATERIAL_TRANSMISSIVE:
+					return shadeHit<MATERIAL_TRANSMISSIVE>( ray, hitInfo, sampled );
+				case MATERIAL_HIGHLIGHT | MATERIAL_TRANSMISSIVE:
+					return shadeHit<MATERIAL_HIGHLIGHT | MATERIAL_TRANSMISSIVE>( ray, hitInfo, sampled );
+				case MATERIAL_REFLECTIVE | MATERIAL_TRANSMISSIVE:
+					return shadeHit<MATERIAL_REFLECTIVE | MATERIAL_TRANSMISSIVE>( ray, hitInfo, sampled );
+				case MATERIAL_HIGHLIGHT | MATERIAL_REFLECTIVE | MATERIAL_TRANSMISSIVE:
+					return shadeHit<MATERIAL_HIGHLIGHT | MATERIAL_REFLECTIVE | MATERIAL_TRANSMISSIVE>( ray, hitInfo, sampled );
+				default:
+					return shadeHit<MATERIAL_GENERIC>( ray, hitInfo, sampled );
+			}
+		}
+
+		/// Color of a ray which hit nothing
+		/**
+			@param		Ray[in]
+			@return		environment map or background color
+		*/
+		rgb missColor( Ray* ray ) const
+		{
+			// huh, i still don't know how this really works, but it does
+			if (_emBg)
+			{
+				float distance = sqrt(ray->getDirection().x() * ray->getDirection().x() + ray->getDirection().y() * ray->getDirection().y());
+				float rad = distance > 0 ? 0.159154943 * acos(ray->getDirection().z()) / distance : 0.0f;
+		
+				int u = (0.5 + ray->getDirection().x() * rad) * _emBgW;			
+				int v = (1 - (0.5 + ray->getDirection().y() * rad)) * _emBgH;
+
+				uint32 pos = (v * _emBgW + u)*3;
+
+				return rgb(_emBg[pos], _emBg[pos+1], _emBg[pos+2]);
+			}
+			else
+				return _background; // background
+		}
+
+		/// Closest intersection of a ray and the scene
+		/**
+			@param		Ray[in]
+			@param		HitInfo[out] closest hit, the primitive stays NULL if nothing was hit
+		*/
+		void findClosestHit( Ray* ray, HitInfo* hitInfo )
+		{
+			for ( std::vector< Primitive* >::iterator it = _scene->primitives.begin(); it != _scene->primitives.end(); ++it )
+			{	
+				// we cast the ray at every primitive (sphere, triangle) in the scene
+				// and see what happens
+				Primitive* primitive = *it;
+				const float distance = hitInfo->getDistance();
+
+				// intersect reports farther hits too, it only keeps the distance and normal of the closer one
+				if ( primitive->intersect( ray, hitInfo ) && hitInfo->getDistance() < distance )	
+					hitInfo->setPrimitive( primitive );
+			}
+		}
+
+		/// Shading kernel of a material class
+		/**
+			Direct light + reflection + refraction. Flags is a combination of materialClass bits, branches
+			for features the class doesn't have are compiled out. MATERIAL_GENERIC checks the material at
+			runtime, it's used for primitives which weren't classified yet.
+
+			The noisy part of the direct light (area lights, or all the lights when they are sampled) can be
+			returned separately, the denoiser filters just that.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@param sampled[out] optional, the part of the direct light estimated by sampling
+			@return rgb
+		*/
+		template <uint32 Flags>
+		rgb shadeHit( Ray* ray, HitInfo* hitInfo, rgb* sampled = NULL )
+		{
+			rgb color;
+
+			if ( _lightSamples )
+			{
+				color = shadeSampledLights<Flags>( ray, hitInfo ); // a few lights picked at random
+
+				if ( sampled )
+					*sampled = color;
+			}
+			else
+			{
+				color = shade<Flags>( ray, hitInfo ); // diffuse + specular
+
+				const rgb area = shadeAreaLight( ray, hitInfo );
+				if ( sampled )
+					*sampled = area;
+
+				if ( _pathRecorder )
+					recordPathNode( ray, hitInfo, color, area );
+
+				color += area;
+			}
+			
+			// reflection
+			if ( Flags & (MATERIAL_REFLECTIVE | MATERIAL_GENERIC) )
+				color += castReflectedRays( ray, hitInfo ); // reflection
+			
+			// refraction
+			if ( Flags & (MATERIAL_TRANSMISSIVE | MATERIAL_GENERIC) )
+				color += castRefractedRays( ray, hitInfo ); // refraction
+
+			return color;
+		}
+
+		/// Area light shader
+		/**
+			Sums the diffuse contribution of every area light in the scene, each one estimated
+			with _areaLightSamples shadow rays, see setAreaLightSamples. Baked triangles read their lightmap
+			instead, see bakeLighting. With the irradiance cache enabled the irradiance is interpolated from
+			nearby records whenever possible.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@return rgb
+		*/
+		rgb shadeAreaLight( Ray* ray, HitInfo* hitInfo )
+		{
+			rgb color;
+
+			if ( _scene->areaLights.empty() )
+				return color;
+
+			rgb direct, area;
+			if ( lookupBaked( ray, hitInfo, direct, area ) )
+			{
+				const material m = hitInfo->getPrimitive()->getMaterial();
+				return m.color() * m.diffuse() * area;
+			}
+
+			if ( _useIrradianceCache )
+			{
+				const material	material	= hitInfo->getPrimitive()->getMaterial();
+				const vector3	hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
+				const vector3	hitNormal	= hitInfo->getNormal();
+
+				rgb irradiance;
+				if ( !_scene->irradianceCache.lookup( hitPoint, hitNormal, irradiance ) )
+				{
+					irradianceSampling sampling;
+					for (std::vector<AreaLight*>::iterator it = _scene->areaLights.begin(); it != _scene->areaLights.end(); ++it)
+						irradiance += areaLightIrradiance( hitPoint, hitNormal, *it, IRRADIANCE_CACHE_SAMPLES, &sampling );
+
+					_scene->irradianceCache.insert( hitPoint, hitNormal, irradiance, sampling.radius() );
+				}
+
+				return material.color() * material.diffuse() * irradiance;
+			}
+			
+			for (std::vector<AreaLight*>::iterator it = _scene->areaLights.begin(); it != _scene->areaLights.end(); ++it)
+				color += shadeAreaLight( ray, hitInfo, *it, _areaLightSamples );
+
+			return color;
+		}
+
+		/// Shades a hit with a single area light
+		/**
+			Samples the area light at random points and sums their diffuse contribution. The result is
+			an estimate of the whole light, no matter how many samples are used.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@param areaLight[in] light to evaluate
+			@param samples[in] number of shadow rays to cast towards the light
+			@return rgb
+		*/
+		rgb shadeAreaLight( Ray* ray, HitInfo* hitInfo, AreaLight* areaLight, uint32 samples )
+		{
+			// hit primitive
+			rgb hitColor		= hitInfo->getPrimitive()->getMaterial().color();
+			vector3 hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );	
+			vector3 hitNormal	= hitInfo->getNormal();
+			float hitDiffuse = hitInfo->getPrimitive()->getMaterial().diffuse();
+
+			return hitColor * hitDiffuse * areaLightIrradiance( hitPoint, hitNormal, areaLight, samples );
+		}
+
+		/// Irradiance from a single area light
+		/**
+			Samples the area light at random points and sums the irradiance they bring to a surface point.
+
+			@param hitPoint[in] surface point
+			@param hitNormal[in] surface normal
+			@param areaLight[in] light to evaluate
+			@param samples[in] number of shadow rays to cast towards the light
+			@param sampling[out] optional, collects sample distances and visibility for the irradiance cache
+			@return rgb
+		*/
+		rgb areaLightIrradiance( vector3 const& hitPoint, vector3 const& hitNormal, AreaLight* areaLight, uint32 samples, irradianceSampling* sampling = NULL )
+		{
+			rgb irradiance;
+
+			// area light
+			float areaDecline	= areaLight->getArea() / samples;
+			rgb areaColor		= areaLight->getColor();
+			vector3 areaNormal	= areaLight->getNormal();
+
+			for ( uint32 i = 0; i < samples; ++i )
+			{																				
+				const float u1 = random();
+				vector3 sample = areaLight->getSample( u1, random() );
+			
+				vector3 shadowRayDir = sample - hitPoint;							
+
+				float distance = shadowRayDir.length();
+
+				shadowRayDir.normalize();
+
+				if ( sampling )
+					sampling->addDistance( distance );
+
+				float intensity = math::vec::scalarProduct( hitNormal, shadowRayDir );
+				if ( intensity > 0.0f )
+				{					
+					const vector3	lightDir	= (hitPoint - sample).normalize();
+														
+					Ray lightRay( sample, lightDir, 0.0f, (sample-hitPoint).length() - EPSILON );					
+
+					// the sample lies on the light's own triangle, which must not occlude it
+					bool occluded = isInShadow(&lightRay, areaLight->getTriangle()->getId(), _scene->lights.size() + areaLight->getIndex());
+
+					if ( sampling )
+						sampling->addVisibility( !occluded );
+
+					if ( occluded )
+						continue;
+
+					float contrib = math::vec::scalarProduct(areaNormal, -1.0f * shadowRayDir);
+					contrib /= areaLight->getDecline(distance);
+				
+					irradiance += contrib * areaDecline * intensity * areaColor;
+				}				
+			}
+			return irradiance;
+		}
+
+		/// Stochastic light shader
+		/**
+			Instead of evaluating every light in the scene, picks _lightSamples lights at random. The probability
+			of picking a light is proportional to its emitted power, see updateLightCdf, so a pick is a binary
+			search and only the picked lights are shaded: the cost of a hit grows with the logarithm of the
+			number of lights. Point lights in SGL don't fall off with distance, so the power is their whole
+			estimate but the cosine, which shade evaluates. Picked lights are weighted by 1 / (count * probability)
+			to keep the estimate unbiased.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@return rgb
+		*/
+		template <uint32 Flags>
+		rgb shadeSampledLights( Ray* ray, HitInfo* hitInfo )
+		{
+			rgb color;
+
+			std::vector<float> const& cdf = _scene->lightCdf;
+			if ( cdf.empty() || cdf.back() <= 0.0f )
+				return color;
+
+			const float total = cdf.back();
+
+			for ( uint32 i = 0; i < _lightSamples; ++i )
+			{
+				float u = total * random();
+
+				uint32 picked = std::upper_bound( cdf.begin(), cdf.end(), u ) - cdf.begin();
+				picked = std::min( picked, static_cast<uint32>( cdf.size() ) - 1 );
+
+				float weight = cdf[picked] - ( picked ? cdf[picked - 1] : 0.0f );
+				if ( weight <= 0.0f )
+					continue;
+
+				// 1 / (count * probability)
+				weight = total / ( weight * _lightSamples );
+
+				if ( picked < _scene->lights.size() )
+					color += shade<Flags>( ray, hitInfo, picked ) * weight;
+				else
+					color += shadeAreaLight( ray, hitInfo, _scene->areaLights[picked - _scene->lights.size()], 1 ) * weight;
+			}
+			return color;
+		}
+
+		/// Rebuilds the distribution shadeSampledLights picks lights from, when the lights changed
+		/**
+			The cumulative power of the lights, point lights first: the luminance of a point light, the
+			luminance times the area of an area light.
+		*/
+		void updateLightCdf()
+		{
+			if ( _scene->lightCdfVersion == _scene->version && _scene->lightCdf.size() == _scene->lights.size() + _scene->areaLights.size() )
+				return;
+
+			_scene->lightCdf.resize( _scene->lights.size() + _scene->areaLights.size() );
+
+			float total = 0.0f;
+			for ( uint32 i = 0; i < _scene->lights.size(); ++i )
+			{
+				total += _scene->lights[i]->getColor().luminance();
+				_scene->lightCdf[i] = total;
+			}
+
+			for ( uint32 i = 0; i < _scene->areaLights.size(); ++i )
+			{
+				total += _scene->areaLights[i]->getColor().luminance() * _scene->areaLights[i]->getArea();
+				_scene->lightCdf[_scene->lights.size() + i] = total;
+			}
+
+			_scene->lightCdfVersion = _scene->version;
+		}
+
+		/// Casts reflected rays
+		/**
+			In case the material is specular, it casts a reflected ray.
+
+			@param		Ray
+			@param		HitInfo[in]	Info structure to describe the intersection of the ray and the scene
+			@return		rgb
+		*/
+		const rgb castReflectedRays( Ray* ray, HitInfo* hitInfo )
+		{
+			float specular = hitInfo->getPrimitive()->getMaterial().specular();
+			if ( specular > 0.0f )
+			{
+				const vector3 hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
+				const vector3 normal = hitInfo->getNormal();
+
+				vector3 direction = ray->getDirection() - 2.0f * math::vec::scalarProduct( ray->getDirection(), normal) * normal;
+				direction.normalize();						
+
+				Ray reflectedRay(hitPoint + direction * EPSILON, direction);
+				reflectedRay.setDepth( ray->getDepth() + 1 );
+
+				// recorded hits along the reflected ray contribute through the specular factor,
+				// the weight isn't touched otherwise, parallel renders share it
+				const float weight = _pathWeight;
+				if ( _pathRecorder )
+					_pathWeight *= specular;
+
+				const rgb color = intersectRayWithScene( &reflectedRay, &HitInfo() ) * specular;
+
+				if ( _pathRecorder )
+					_pathWeight = weight;
+				return color;
+			}
+			return rgb();
+		}
+
+		/// Casts refracted rays
+		/**
+			In case the material is transmittive (light can go through) it casts a transmittive ray.
+
+			@param		Ray[in]
+			@param		HitInfo[in]	Info structure to describe the intersection of the ray and the scene
+			@return		rgb
+		*/
+		const rgb castRefractedRays( Ray* ray, HitInfo* hitInfo )
+		{
+			float transmittence = hitInfo->getPrimitive()->getMaterial().transmittence();
+			if( transmittence > 0.0f )
+			{					
+				float refraction = hitInfo->getPrimitive()->getMaterial().refraction();
+				const vector3 hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
+				vector3 normal = hitInfo->getNormal();
+
+				float d = math::vec::scalarProduct(ray->getDirection(), normal);
+				float gamma;
+			
+				if( d < 0.0f )
+				{				
+					gamma = 1.0f / refraction;
+				}
+				else
+				{					
+					gamma = refraction;
+					d = -d;
+					normal = -1.0f * normal;
+				}
+
+				float sqrterm = 1.0f - gamma * gamma * (1.0f - d * d);
+
+				sqrterm = d * gamma + sqrtf(sqrterm);
+					
+				uint32 depth = ray->getDepth() + 1;
+				vector3 direction = -sqrterm * normal + ray->getDirection() * gamma;
+				vector3 origin = hitPoint + direction * EPSILON;								
+					
+				Ray refractedRay(origin, direction);
+				refractedRay.setDepth(depth);
+
+				const float weight = _pathWeight;
+				if ( _pathRecorder )
+					_pathWeight *= transmittence;
+
+				const rgb color = intersectRayWithScene( &refractedRay, &HitInfo() ) * transmittence;
+
+				if ( _pathRecorder )
+					_pathWeight = weight;
+				return color;
+			}
+			return rgb();
+		}
+
+		/// Checks if hit is in shadow
+		/**
+			Functions similarly to intersectWithScene, although without any overhead. A ray is given with
+			origin inside hitpoint and range limited to light distance. Then it checks if it hits something
+			along the way. If it does, the hit point is inside a shadow.
+
+			@param ray[in] ray
+			@param ignoreId[in] id of a primitive which can't occlude the ray (usually the light itself)
+			@param lightSlot[in] light the ray belongs to (see findOccluder)
+			@return bool
+		*/
+		bool isInShadow( Ray* ray, uint32 ignoreId = NO_PRIMITIVE, uint32 lightSlot = NO_LIGHT )
+		{						
+			return findOccluder( ray, ignoreId, lightSlot ) != NULL;
+		}
+
+		/// Finds a primitive occluding a shadow ray
+		/**
+			Shadow rays towards the same light from neighbouring hit points are usually blocked by the same
+			primitive. Every thread remembers the last OCCLUDER_CACHE_SIZE occluders of every light, these are
+			tested before the rest of the scene.
+
+			@param ray[in] ray
+			@param ignoreId[in] id of a primitive which can't occlude the ray (usually the light itself)
+			@param lightSlot[in] point light index, or number of point lights + area light index,
+				NO_LIGHT skips the occluder cache
+			@return the first primitive found along the ray or NULL
+		*/
+		const Primitive* findOccluder( Ray* ray, uint32 ignoreId = NO_PRIMITIVE, uint32 lightSlot = NO_LIGHT )
+		{
+			uint32* cache = NULL;
+			if ( lightSlot != NO_LIGHT && threadIndex() < _occluderCache.size() )
+			{
+				std::vector<uint32>& threadCache = _occluderCache[threadIndex()];
+				if ( ( lightSlot + 1 ) * OCCLUDER_CACHE_SIZE <= threadCache.size() )
+					cache = &threadCache[lightSlot * OCCLUDER_CACHE_SIZE];
+			}
+
+			if ( cache )
+			{
+				for ( uint32 i = 0; i < OCCLUDER_CACHE_SIZE && cache[i] != NO_PRIMITIVE; ++i )
+				{
+					Primitive* primitive = _scene->primitives[cache[i]];
+					if ( primitive->getId() != ignoreId && primitive->intersect( ray ) )
+					{
+						// most recent first
+						std::rotate( cache, cache + i, cache + i + 1 );
+
+						++_threadStats[threadIndex()].occluderCacheHits;
+						return primitive;
+					}
+				}
+			}
+
+			for ( std::vector< Primitive* >::iterator it = _scene->primitives.begin(); it != _scene->primitives.end(); ++it )
+			{	
+				// we cast the ray at every primitive (sphere, triangle) in the scene
+				// and see what happens
+				Primitive* primitive = *it;
+				if ( primitive->getId() != ignoreId && primitive->intersect( ray ) )										
+				{
+					if ( cache )
+					{
+						std::copy_backward( cache, cache + OCCLUDER_CACHE_SIZE - 1, cache + OCCLUDER_CACHE_SIZE );
+						cache[0] = primitive->getId();
+
+						// lit rays would miss any cache, they aren't counted as misses
+						++_threadStats[threadIndex()].occluderCacheMisses;
+					}
+					return primitive;				
+				}
+			}
+
+			if ( cache )
+				++_threadStats[threadIndex()].unoccludedShadowRays;
+			return NULL;			
+		}
+
+		/// Closest hits of a batch of rays
+		/**
+			Rays skip the clusters whose bounding sphere they miss, see buildClusters, the primitives defined
+			after the last prepareScene are tested one by one. The rays are split among the threads, nothing
+			is allocated per ray. Directions don't need to be normalized, distances are measured in their
+			lengths.
+
+			@param origins[in] x, y, z of every ray
+			@param directions[in] x, y, z of every ray
+			@param count[in] number of rays
+			@param distances[out] optional, distance of every hit, -1 for a miss
+			@param primitives[out] optional, id of every hit primitive, -1 for a miss
+		*/
+		void intersectRays( const float* origins, const float* directions, uint32 count, float* distances, int32* primitives ) const
+		{
+			#pragma omp parallel for schedule(dynamic, RAY_QUERY_CHUNK)
+			for ( int32 i = 0; i < static_cast<int32>( count ); ++i )
+			{
+				const vector3 direction( directions[3 * i], directions[3 * i + 1], directions[3 * i + 2] );
+				const float length = direction.length();
+
+				HitInfo hitInfo;
+				if ( length > 0.0f )
+				{
+					Ray ray( vector3( origins[3 * i], origins[3 * i + 1], origins[3 * i + 2] ), direction * ( 1.0f / length ) );
+					findClosestHitInClusters( &ray, &hitInfo );
+				}
+
+				const Primitive* primitive = hitInfo.getPrimitive();
+
+				if ( distances )
+					distances[i] = primitive ? hitInfo.getDistance() / length : -1.0f;
+				if ( primitives )
+					primitives[i] = primitive ? static_cast<int32>( primitive->getId() ) : -1;
+			}
+		}
+
+		/// Occlusion of a batch of rays, like intersectRays without looking for the closest hit
+		/**
+			@param origins[in] x, y, z of every ray
+			@param directions[in] x, y, z of every ray
+			@param maxDistances[in] optional, hits farther than this (in lengths of the direction) don't count
+			@param count[in] number of rays
+			@param occluded[out] 1 when the ray hits a primitive, 0 otherwise
+		*/
+		void occludeRays( const float* origins, const float* directions, const float* maxDistances, uint32 count, int32* occluded ) const
+		{
+			#pragma omp parallel for schedule(dynamic, RAY_QUERY_CHUNK)
+			for ( int32 i = 0; i < static_cast<int32>( count ); ++i )
+			{
+				const vector3 direction( directions[3 * i], directions[3 * i + 1], directions[3 * i + 2] );
+				const float length = direction.length();
+
+				occluded[i] = 0;
+				if ( length <= 0.0f )
+					continue;
+
+				const float tmax = maxDistances ? maxDistances[i] * length : std::numeric_limits<float>::max();
+
+				Ray ray( vector3( origins[3 * i], origins[3 * i + 1], origins[3 * i + 2] ), direction * ( 1.0f / length ), 0.0f, tmax );
+				occluded[i] = hasHitInClusters( &ray ) ? 1 : 0;
+			}
+		}
+
+		/// Shadow ray from a point light towards a hit point
+		static Ray pointLightRay( vector3 const& lightPos, vector3 const& hitPoint )
+		{
+			const vector3 lightDir = (hitPoint - lightPos).normalize();
+
+			return Ray( lightPos, lightDir, 0.0f, (lightPos-hitPoint).length() - EPSILON );
+		}
+
+		/// Phong shader
+		/**
+			Based on given hit info and ray parameters, calculates a resulting color. Both diffuse and shiny.
+			contributions. Baked triangles without a highlight read their lightmap instead of casting shadow
+			rays, see bakeLighting.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@return const color
+		*/
+		template <uint32 Flags>
+		const rgb shade( Ray* ray, HitInfo* hitInfo )
+		{
+			rgb color; // initial color vector : #000000
+
+			rgb direct, area;
+			if ( hasBakedDiffuse( hitInfo->getPrimitive() ) && lookupBaked( ray, hitInfo, direct, area ) )
+			{
+				const material m = hitInfo->getPrimitive()->getMaterial();
+				return m.color() * m.diffuse() * direct;
+			}
+
+			// contribution of every light source
+			for ( uint32 i = 0; i < _scene->lights.size(); ++i )
+				color += shade<Flags>( ray, hitInfo, i );
+
+			return color;
+		}
+
+		/// Phong shader for a single light
+		/**
+			The highlight is evaluated only for material classes with MATERIAL_HIGHLIGHT, see shadeHit.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@param lightIndex[in] index of the point light to evaluate
+			@return const color
+		*/
+		template <uint32 Flags>
+		const rgb shade( Ray* ray, HitInfo* hitInfo, uint32 lightIndex )
+		{
+			return shade<Flags>( ray, hitInfo, *_scene->lights[lightIndex], lightIndex );
+		}
+
+		/// Phong shader for a given state of a point light
+		/**
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@param light[in] position and color of the light
+			@param lightIndex[in] index of the light, selects its shadow hints and occluder cache
+			@return const color
+		*/
+		template <uint32 Flags>
+		const rgb shade( Ray* ray, HitInfo* hitInfo, PointLight const& light, uint32 lightIndex )
+		{
+			rgb color;
+
+			const Primitive*	primitive	= hitInfo->getPrimitive();			
+			const vector3		hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
+			const material		material	= primitive->getMaterial();			
+
+			const vector3	hitNormal	= hitInfo->getNormal();				
+			const vector3	lightPos	= light.getPosition();
+			const vector3	shadowDir	= (lightPos - hitPoint).normalize();
+
+			float intensity = math::vec::scalarProduct( hitNormal, shadowDir );
+
+			if ( intensity > 0.0f )
+			{
+				if ( !isLit( ray, hitInfo, lightIndex, lightPos, hitPoint ) )
+					return color;
+				
+				color = phong<Flags>( ray, material, hitNormal, shadowDir, intensity, light.getColor() );
+			}
+			return color;
+		}
+
+		/// Diffuse and specular light of a visible light
+		/**
+			@param ray[in] ray
+			@param material[in] material of the hit primitive
+			@param hitNormal[in] surface normal
+			@param shadowDir[in] direction from the hit towards the light
+			@param intensity[in] cosine of the normal and shadowDir, positive
+			@param lightColor[in] light color
+			@return rgb
+		*/
+		template <uint32 Flags>
+		rgb phong( Ray* ray, material const& material, vector3 const& hitNormal, vector3 const& shadowDir, float intensity, rgb const& lightColor ) const
+		{
+			rgb color = material.color() * material.diffuse() * intensity * lightColor;
+
+			// specular
+			if ( (Flags & MATERIAL_HIGHLIGHT) || ( (Flags & MATERIAL_GENERIC) && material.shine() > 0.0f ) )
+			{
+				vector3 shineDir = shadowDir - ( 2.0f * math::vec::scalarProduct( shadowDir, hitNormal ) * hitNormal );				
+				intensity = math::vec::scalarProduct( shineDir, ray->getDirection() );				
+				intensity = _fastShading ? specularPower( intensity, material.shine() ) : pow( intensity, material.shine() );					
+				intensity = std::min( intensity, 10000.0f );
+
+				color += material.specular() * intensity * lightColor;
+			}
+			return color;
+		}
+
+		/// Direct light of a hit without reflections and refractions
+		/**
+			The shader of the rasterized preview. Point lights are shaded as by shade, an area light as a single
+			sample at the centroid of its triangle. With shadow maps, an area light is averaged over the points
+			of AreaLight::getShadowSample instead, each shadowed by its own map. Baked triangles take all their
+			diffuse light from the lightmap, see bakeLighting, only highlights are added.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result, no primitive for the background
+			@param shadowMaps[in] optional, a map for every point light followed by AREA_SHADOW_SAMPLES maps for
+				every area light, see Context::updateShadowMaps
+			@return rgb
+		*/
+		rgb shadePreview( Ray* ray, HitInfo* hitInfo, const std::vector<CubeShadowMap>* shadowMaps = NULL )
+		{
+			Primitive* primitive = hitInfo->getPrimitive();
+
+			if ( !primitive )
+				return missColor( ray );
+
+			if ( primitive->isLight() )
+				return primitive->getEmissiveMaterial()->color();
+
+			rgb color;
+
+			const vector3	hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
+			const vector3	hitNormal	= hitInfo->getNormal();
+			material		material	= primitive->getMaterial();
+
+			rgb direct, area;
+			const bool baked = lookupBaked( ray, hitInfo, direct, area );
+
+			if ( baked )
+			{
+				color = material.color() * material.diffuse() * ( direct + area );
+
+				// phong adds just the highlight
+				material = ::material( material.color(), 0.0f, material.specular(), material.shine(), material.transmittence(), material.refraction() );
+			}
+
+			for ( uint32 i = 0; i < _scene->lights.size(); ++i )
+			{
+				if ( baked && !( material.shine() > 0.0f && material.specular() > 0.0f ) )
+					break;
+
+				const vector3 shadowDir = ( _scene->lights[i]->getPosition() - hitPoint ).normalize();
+				const float intensity	= math::vec::scalarProduct( hitNormal, shadowDir );
+
+				if ( intensity > 0.0f && ( !shadowMaps || (*shadowMaps)[i].isLit( hitPoint, hitNormal ) ) )
+					color += phong<MATERIAL_GENERIC>( ray, material, hitNormal, shadowDir, intensity, _scene->lights[i]->getColor() );
+			}
+
+			if ( baked )
+				return color;
+
+			const uint32 samples = shadowMaps ? AREA_SHADOW_SAMPLES : 1;
+
+			for ( uint32 i = 0; i < _scene->areaLights.size(); ++i )
+			{
+				AreaLight* light = _scene->areaLights[i];
+
+				for ( uint32 s = 0; s < samples; ++s )
+				{
+					vector3 shadowDir		= light->getShadowSample( s ) - hitPoint;
+					const float distance	= shadowDir.length();
+					shadowDir.normalize();
+
+					const float intensity = math::vec::scalarProduct( hitNormal, shadowDir );
+
+					if ( intensity <= 0.0f )
+						continue;
+
+					if ( shadowMaps && !(*shadowMaps)[_scene->lights.size() + i * AREA_SHADOW_SAMPLES + s].isLit( hitPoint, hitNormal ) )
+						continue;
+
+					// the same terms as areaLightIrradiance
+					const float contrib = math::vec::scalarProduct( light->getNormal(), -1.0f * shadowDir ) / light->getDecline( distance );
+					color += material.color() * material.diffuse() * ( contrib * light->getArea() * intensity / samples * light->getColor() );
+				}
+			}
+			return color;
+		}
+
+		/// Change of the light of a hit caused by an edit of a point light
+		/**
+			Phong shading is linear in the light color, so when the light kept its position the hit is shaded
+			once by a white light and scaled by the color difference, with a single shadow ray.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@param old[in] the light before the edit
+			@param lightIndex[in] index of the edited light
+			@return new minus old contribution of the light
+		*/
+		rgb pointLightDelta( Ray* ray, HitInfo* hitInfo, PointLight const& old, uint32 lightIndex )
+		{
+			const PointLight& light = *_scene->lights[lightIndex];
+
+			const vector3 position	= light.getPosition();
+			const vector3 previous	= old.getPosition();
+
+			if ( position.x() == previous.x() && position.y() == previous.y() && position.z() == previous.z() )
+			{
+				rgb unit = shade<MATERIAL_GENERIC>( ray, hitInfo, PointLight( position, WHITE ), lightIndex );
+				rgb difference = light.getColor();
+
+				return unit * ( difference - old.getColor() );
+			}
+
+			rgb color = shade<MATERIAL_GENERIC>( ray, hitInfo, light, lightIndex );
+			return color - shade<MATERIAL_GENERIC>( ray, hitInfo, old, lightIndex );
+		}
+
+		/// Phong exponent of the fast shading mode
+		/**
+			Integer exponents (the usual case) are computed by squaring, others by the exp2/log2 approximation
+			with relative error below shine * 6.5e-6 + 1.8e-7, see math::fastPow. Unlike pow, negative cosines
+			with a fractional exponent give 0 instead of NaN.
+
+			@param cosine[in] cosine of the reflected light and view direction
+			@param shine[in] Phong exponent
+			@return float
+		*/
+		static float specularPower( float cosine, float shine )
+		{
+			const uint32 n = static_cast<uint32>( shine );
+
+			if ( static_cast<float>( n ) == shine && n <= MAX_SQUARING_SHINE )
+				return math::powi( cosine, n );
+
+			return math::fastPow( cosine, shine );
+		}
+
+		/// Point light visibility
+		/**
+			Primary hits on the primitive the shadow hints were set up for take the visibility from the hints,
+			everything else casts a shadow ray.
+
+			@param ray[in] ray
+			@param hitInfo[in] hit result
+			@param lightIndex[in] index of the point light
+			@param lightPos[in] light position
+			@param hitPoint[in] hit position
+			@return true when the light reaches the hit point
+		*/
+		bool isLit( Ray* ray, HitInfo* hitInfo, uint32 lightIndex, vector3 const& lightPos, vector3 const& hitPoint )
+		{
+			if ( !_shadowHints.empty() && !ray->getDepth() && hitInfo->getPrimitive()->getId() == _shadowHintPrimitive )
+			{
+				if ( _shadowHints[lightIndex] == SHADOW_LIT )
+					return true;
+				if ( _shadowHints[lightIndex] == SHADOW_OCCLUDED )
+					return false;
+			}
+
+			Ray lightRay = pointLightRay( lightPos, hitPoint );
+			return !isInShadow( &lightRay, NO_PRIMITIVE, lightIndex );
+		}
+
+		/// Sets the visibility of point lights for the following primary hits
+		/**
+			Used by the shadow sharing render, which knows the visibility of whole pixel blocks. Hints only apply
+			to primary hits on the given primitive, so pixels where the block classification doesn't hold still
+			cast their own shadow rays.
+
+			@param primitiveId[in] primitive the hints apply to
+			@param hints[in] SHADOW_LIT, SHADOW_OCCLUDED or SHADOW_UNKNOWN for every point light
+		*/
+		void setShadowHints( uint32 primitiveId, std::vector<uint8> const& hints )
+		{
+			_shadowHintPrimitive = primitiveId;
+			_shadowHints = hints;
+		}
+
+		void clearShadowHints()
+		{ _shadowHints.clear(); }
+
+		/// Primary visibility of point lights at a pixel
+		/**
+			Traces the primary ray of the pixel and a shadow ray towards every point light which faces
+			the hit. Used to build the lattice of the shadow sharing render.
+
+			@param x[in] X coord
+			@param y[in] Y coord
+			@param occluders[out] for every point light, id of the occluding primitive, NO_PRIMITIVE when lit
+				or SHADOW_UNKNOWN_ID when the light is behind the surface
+			@return id of the hit primitive, NO_PRIMITIVE when nothing (or a light) was hit
+		*/
+		uint32 primaryVisibility( uint32 x, uint32 y, uint32* occluders )
+		{
+			Ray ray = generateRay( x, y );
+			HitInfo hitInfo;
+
+			findClosestHit( &ray, &hitInfo );
+
+			Primitive* primitive = hitInfo.getPrimitive();
+			if ( !primitive || primitive->isLight() )
+				return NO_PRIMITIVE;
+
+			const vector3 hitPoint = ray.getOrigin() + ( ray.getDirection() * hitInfo.getDistance() );
+
+			for ( uint32 i = 0; i < _scene->lights.size(); ++i )
+			{
+				const vector3 lightPos = _scene->lights[i]->getPosition();
+
+				if ( math::vec::scalarProduct( hitInfo.getNormal(), (lightPos - hitPoint).normalize() ) <= 0.0f )
+				{
+					occluders[i] = SHADOW_UNKNOWN_ID;
+					continue;
+				}
+
+				Ray lightRay = pointLightRay( lightPos, hitPoint );
+				const Primitive* occluder = findOccluder( &lightRay, NO_PRIMITIVE, i );
+
+				occluders[i] = occluder ? occluder->getId() : NO_PRIMITIVE;
+			}
+			return primitive->getId();
+		}
+
+		uint32 getLightCount() const
+		{ return _scene->lights.size(); }
+
+		std::vector<Primitive*> const& getPrimitives() const
+		{ return _scene->primitives; }
+
+		PointLight const& getLight( uint32 index ) const
+		{ return *_scene->lights[index]; }
+
+		/// Moves/recolors a point light
+		void setLight( uint32 index, vector3 const& position, rgb const& color )
+		{
+			const vector3 positions[2] = { _scene->lights[index]->getPosition(), position };
+			invalidateLightmaps( positions, 2 );
+
+			_scene->lights[index]->setPosition( position );
+			_scene->lights[index]->setColor( color );
+			invalidateCaches();
+		}
+
+		uint32 getAreaLightCount() const
+		{ return _scene->areaLights.size(); }
+
+		/// Replaces the emission of an area light
+		void setAreaLightEmission( uint32 index, emissiveMaterial* em )
+		{
+			_scene->areaLights[index]->setEmissiveMaterial( em );
+			invalidateCaches();
+			invalidateLightmaps( _scene->areaLights[index] );
+		}
+
+		/// Prepares per-thread state for a new render
+		/**
+			Resets the render statistics and the occluder caches, which are sized for the current lights
+			and number of threads, seeds the random generators of the threads and brings the light
+			distribution of the scene up to date.
+		*/
+		void beginRender()
+		{
+			const uint32 threads = threadCount();
+
+			_threadStats.assign( threads, sglRenderStats() );
+			_occluderCache.assign( threads, std::vector<uint32>( ( _scene->lights.size() + _scene->areaLights.size() ) * OCCLUDER_CACHE_SIZE, NO_PRIMITIVE ) );
+
+			// every render draws other random numbers, so the noise averages out over renders
+			++_frame;
+			_random.resize( threads );
+			for ( uint32 i = 0; i < threads; ++i )
+				_random[i].setSeed( _frame * threads + i );
+
+			updateLightCdf();
+		}
+
+		/// Restarts the random numbers of the calling thread
+		/**
+			Parallel renders seed every tile, so an image doesn't depend on which thread traced which tile.
+
+			@param seed[in] number of the tile
+		*/
+		void seedRandom( uint32 seed )
+		{ _random[threadIndex()].setSeed( _frame * 0x9e3779b1U + seed ); }
+
+		/// Uniform random number in [0, 1) from the generator of the calling thread
+		float random()
+		{ return _random[threadIndex()].next(); }
+
+		/// Statistics of the last render summed over all the threads
+		sglRenderStats getStats() const
+		{
+			sglRenderStats stats = sglRenderStats();
+
+			for ( std::vector<sglRenderStats>::const_iterator it = _threadStats.begin(); it != _threadStats.end(); ++it )
+			{
+				stats.occluderCacheHits		+= it->occluderCacheHits;
+				stats.occluderCacheMisses	+= it->occluderCacheMisses;
+				stats.unoccludedShadowRays	+= it->unoccludedShadowRays;
+			}
+			return stats;
+		}
+
+		/// Classifies the materials of the scene
+		/**
+			Called at the end of the scene definition. Every primitive gets the material class which selects
+			its shading kernel, see shadeHit, and the primitives are grouped for culling, see buildClusters.
+		*/
+		void prepareScene()
+		{
+			for ( std::vector< Primitive* >::iterator it = _scene->primitives.begin(); it != _scene->primitives.end(); ++it )
+				(*it)->setMaterialClass( classifyMaterial( (*it)->getMaterial() ) );
+
+			buildClusters();
+			updateLightCdf();
+		}
+
+		/// Groups the primitives into clusters with a bounding sphere
+		/**
+			A cluster takes CULL_CLUSTER_SIZE consecutive primitives. Primitives defined one after another
+			usually belong to the same object, so their bounds stay tight without sorting the scene.
+		*/
+		void buildClusters()
+		{
+			_scene->clusters.clear();
+
+			for ( uint32 first = 0; first < _scene->primitives.size(); first += CULL_CLUSTER_SIZE )
+			{
+				primitiveCluster cluster;
+				cluster.first = first;
+				cluster.count = std::min( CULL_CLUSTER_SIZE, static_cast<uint32>( _scene->primitives.size() ) - first );
+
+				vector3 lower, upper;
+				_scene->primitives[first]->getBounds( lower, upper );
+
+				for ( uint32 i = first + 1; i < first + cluster.count; ++i )
+				{
+					vector3 l, u;
+					_scene->primitives[i]->getBounds( l, u );
+
+					lower = vector3( std::min( lower.x(), l.x() ), std::min( lower.y(), l.y() ), std::min( lower.z(), l.z() ) );
+					upper = vector3( std::max( upper.x(), u.x() ), std::max( upper.y(), u.y() ), std::max( upper.z(), u.z() ) );
+				}
+
+				cluster.center = 0.5f * ( lower + upper );
+				cluster.radius = 0.5f * ( upper - lower ).length();
+
+				_scene->clusters.push_back( cluster );
+			}
+		}
+
+		/// Checks whether a ray passes through the bounding sphere of a cluster closer than a distance
+		static bool crossesCluster( Ray const& ray, primitiveCluster const& cluster, float tmax )
+		{
+			const vector3 toCenter = cluster.center - ray.getOrigin();
+
+			const float along = math::vec::scalarProduct( toCenter, ray.getDirection() );
+			const float offset = math::vec::scalarProduct( toCenter, toCenter ) - along * along;
+			const float radius2 = cluster.radius * cluster.radius;
+
+			if ( offset > radius2 )
+				return false;
+
+			const float half = std::sqrt( radius2 - offset );
+			return along + half >= ray.tmin() && along - half <= tmax;
 		}
 
-		void addPrimitive( Primitive* primitive )
+		/// Closest hit like findClosestHit, testing only the clusters the ray crosses
+		void findClosestHitInClusters( Ray* ray, HitInfo* hitInfo ) const
 		{
-			_primitives.push_back( primitive );
+			for ( std::vector<primitiveCluster>::const_iterator it = _scene->clusters.begin(); it != _scene->clusters.end(); ++it )
+			{
+				if ( !crossesCluster( *ray, *it, std::min( ray->tmax(), hitInfo->getDistance() ) ) )
+					continue;
+
+				for ( uint32 i = it->first; i < it->first + it->count; ++i )
+				{
+					const float distance = hitInfo->getDistance();
+
+					if ( _scene->primitives[i]->intersect( ray, hitInfo ) && hitInfo->getDistance() < distance )
+						hitInfo->setPrimitive( _scene->primitives[i] );
+				}
+			}
+
+			// not clustered yet
+			for ( uint32 i = _scene->clusters.empty() ? 0 : _scene->clusters.back().first + _scene->clusters.back().count; i < _scene->primitives.size(); ++i )
+			{
+				const float distance = hitInfo->getDistance();
+
+				if ( _scene->primitives[i]->intersect( ray, hitInfo ) && hitInfo->getDistance() < distance )
+					hitInfo->setPrimitive( _scene->primitives[i] );
+			}
 		}
 
-		/// Casts a ray at an [x, y] coordinate
-		/**
-			Casts a ray at an [x, y] coordinate in viewport space.
+		/// Checks whether a ray hits anything, testing only the clusters the ray crosses
+		bool hasHitInClusters( Ray* ray ) const
+		{
+			for ( std::vector<primitiveCluster>::const_iterator it = _scene->clusters.begin(); it != _scene->clusters.end(); ++it )
+			{
+				if ( !crossesCluster( *ray, *it, ray->tmax() ) )
+					continue;
 
-			@param		x[in] X coord
-			@param		y[in] Y coord
-			@return		color of the reflection
-		*/
-		const rgb castRay( uint32 x, uint32 y )
-		{					
-			HitInfo hitInfo;
-			return intersectRayWithScene( &generateRay(x, y), &hitInfo );		
+				for ( uint32 i = it->first; i < it->first + it->count; ++i )
+					if ( _scene->primitives[i]->intersect( ray ) )
+						return true;
+			}
+
+			for ( uint32 i = _scene->clusters.empty() ? 0 : _scene->clusters.back().first + _scene->clusters.back().count; i < _scene->primitives.size(); ++i )
+				if ( _scene->primitives[i]->intersect( ray ) )
+					return true;
+
+			return false;
 		}
 
-		/// Generates a ray for an [x, y] coordinate
-		/**
-			Based on given [x, y] coordinates, it returns a ray. Therefore we need to set ray origin (0, 0, 0) and 
-			a direction inverse-transformation-matrix * x-y-vector.
+		/// Clusters of the primitives defined up to the last sglEndScene
+		std::vector<primitiveCluster> const& getClusters() const
+		{ return _scene->clusters; }
 
-			@param		x[in] X coord
-			@param		y[in] Y coord
-			@return		Ray
+		/// Material class of a material
+		/**
+			@param m[in] material
+			@return combination of materialClass bits
 		*/
-		Ray generateRay( uint32 x, uint32 y )
-		{			
-			float xn = 2.0f * static_cast<float>(x) / static_cast<float>(_viewport.width()) - 1.0f;
-			float yn = 2.0f * static_cast<float>(y) / static_cast<float>(_viewport.height()) - 1.0f;
+		static uint32 classifyMaterial( material const& m )
+		{
+			uint32 materialClass = MATERIAL_DIFFUSE;
 
-			vertex origin(xn, yn, -1.0f);
-			origin *= _inverseMVP;
-			origin.wNormalize();
+			if ( m.shine() > 0.0f && m.specular() > 0.0f )
+				materialClass |= MATERIAL_HIGHLIGHT;
 
-			vertex direction(xn, yn, 1.0f);
-			direction *= _inverseMVP;
-			direction.wNormalize();			
+			if ( m.specular() > 0.0f )
+				materialClass |= MATERIAL_REFLECTIVE;
 
-			return Ray( vector3(origin), vector3(direction - origin).normalize() );
+			if ( m.transmittence() > 0.0f )
+				materialClass |= MATERIAL_TRANSMISSIVE;
+
+			return materialClass;
 		}
 
-		/// Intersection of the scene and a ray
+		/// Enables/disables approximate math in shading
+		void setFastShading( bool value )
+		{ _fastShading = value; }
+
+		/// Enables/disables the irradiance cache for area lights
+		void enableIrradianceCache( bool value )
+		{ _useIrradianceCache = value; }
+
+		/// Drops all irradiance cache records, called whenever the scene or its lights change
 		/**
-			Intersects the ray with all the primitives in the scene. If it hits a primitive, it writes the details
-			inside hitInfo and calculates the color of the reflection based on the Phong model. The color then bubbles up
-			to castRay-renderScene and is written inside the color buffer.
+			Also bumps the scene version, so that caches kept outside of the ray tracer can find out.
+		*/
+		void invalidateCaches()
+		{ 
+			_scene->irradianceCache.clear(); 
+			++_scene->version;
+		}
 
-			I case we hit something, we also check the material we hit.
+		/// Enables/disables the baked diffuse light, see bakeLighting
+		void enableBakedLighting( bool value )
+		{ _useBakedLighting = value; }
 
-			In case of specular materials, we generate reflective rays/ In case of refractive materials,
-			we generate refractive rays. We only generate rays up until MAX_RAY_DEPTH, to prevent deadlock.
+		/// Bakes the diffuse light of the triangles whose lightmaps are missing or out of date
+		/**
+			Every triangle gets a Lightmap whose corners lie about 1 / BAKE_RESOLUTION of the scene size apart,
+			at most BAKE_MAX_SUBDIVISIONS along an edge. A corner stores the irradiance of the point lights,
+			with a shadow ray each, and of the area lights, with BAKE_AREA_SAMPLES shadow rays each, so the
+			baked area light is much smoother than the one shaded per hit. Spheres and light patches aren't
+			baked.
 
-			@param		Ray[in]
-			@param		HitInfo[in]	Info structure to describe the intersection of the ray and the scene
-			@return		rgb
+			Lightmaps stay valid until a light which can reach their triangle changes or a new primitive
+			lands between them and a light, see invalidateLightmaps and invalidateOccludedLightmaps, so only
+			those are baked again.
+
+			@return number of lightmaps baked
 		*/
-		rgb intersectRayWithScene( Ray* ray, HitInfo* hitInfo )
-		{						
-			rgb color;	
+		uint32 bakeLighting()
+		{
+			_scene->lightmaps.resize( _scene->primitives.size() );
 
-			if ( ray->getDepth() > MAX_RAY_DEPTH )
-				return color;
+			vector3 lower( std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() );
+			vector3 upper = -1.0f * lower;
 
-			// area lights are stored in a separate container
-			// this is a little hack to return a pure color in case we hit an emissive area
-			for ( std::vector<AreaLight*>::iterator it = _areaLights.begin(); it != _areaLights.end(); ++it )
+			for ( std::vector<Primitive*>::const_iterator it = _scene->primitives.begin(); it != _scene->primitives.end(); ++it )
 			{
-				AreaLight* light = *it;
+				vector3 l, u;
+				(*it)->getBounds( l, u );
 
-				Triangle* triangle = light->getTriangle();
-				if ( triangle->intersect( ray, hitInfo ) )
-					return light->getColor();
+				lower = vector3( std::min( lower.x(), l.x() ), std::min( lower.y(), l.y() ), std::min( lower.z(), l.z() ) );
+				upper = vector3( std::max( upper.x(), u.x() ), std::max( upper.y(), u.y() ), std::max( upper.z(), u.z() ) );
 			}
 
-			for ( std::vector< Primitive* >::iterator it = _primitives.begin(); it != _primitives.end(); ++it )
-			{	
-				// we cast the ray at every primitive (sphere, triangle) in the scene
-				// and see what happens
-				Primitive* primitive = *it;
-				if ( primitive->intersect( ray, hitInfo ) )	
-					hitInfo->setPrimitive( primitive );
-			}
+			const float texel = ( upper - lower ).length() / BAKE_RESOLUTION;
 
-			// we hit something
-			if ( Primitive* primitive = hitInfo->getPrimitive() )
-			{				
-				color = shade( ray, hitInfo ); // diffuse + specular
+			uint32 baked = 0;
 
-				color += shadeAreaLight( ray, hitInfo );
-				
-				// reflection
-				color += castReflectedRays( ray, hitInfo ); // reflection
-				
-				// refraction
-				color += castRefractedRays( ray, hitInfo ); // refraction
-			}
-			else	
+			for ( uint32 id = 0; id < _scene->primitives.size(); ++id )
 			{
-				// huh, i still don't know how this really works, but it does
-				if (_emBg)
-				{
-					float distance = sqrt(ray->getDirection().x() * ray->getDirection().x() + ray->getDirection().y() * ray->getDirection().y());
-					float rad = distance > 0 ? 0.159154943 * acos(ray->getDirection().z()) / distance : 0.0f;
-			
-					int u = (0.5 + ray->getDirection().x() * rad) * _emBgW;			
-					int v = (1 - (0.5 + ray->getDirection().y() * rad)) * _emBgH;
+				const Triangle* triangle = dynamic_cast<const Triangle*>( _scene->primitives[id] );
 
-					uint32 pos = (v * _emBgW + u)*3;
+				if ( !triangle || triangle->isLight() || _scene->lightmaps[id].isValid() )
+					continue;
 
-					return rgb(_emBg[pos], _emBg[pos+1], _emBg[pos+2]);
-				}
-				else
-					return _background; // background
-			}
-			
-			return color;
-		}
+				const float edge = std::max( triangle->edge1().length(), std::max( triangle->edge2().length(), ( triangle->c() - triangle->b() ).length() ) );
+				const uint32 subdivisions = std::min( std::max( static_cast<uint32>( std::ceil( edge / texel ) ), 1u ), BAKE_MAX_SUBDIVISIONS );
 
-		rgb shadeAreaLight( Ray* ray, HitInfo* hitInfo )
-		{
-			rgb color;
-			
-			for (std::vector<AreaLight*>::iterator it = _areaLights.begin(); it != _areaLights.end(); ++it)
-			{					
-				AreaLight* areaLight = *it;
-				
-				// area light
-				float areaDecline	= areaLight->getArea() / AREA_LIGHT_SAMPLES;
-				rgb areaColor		= areaLight->getColor();
-				vector3 areaNormal	= areaLight->getNormal();
-				// hit primitive
-				rgb hitColor		= hitInfo->getPrimitive()->getMaterial().color();
-				vector3 hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );	
-				vector3 hitNormal	= hitInfo->getNormal();
-				float hitDiffuse = hitInfo->getPrimitive()->getMaterial().diffuse();
-
-				for ( uint32 i = 0; i < AREA_LIGHT_SAMPLES; ++i )
-				{																				
-					vector3 sample = areaLight->getSample();
-				
-					vector3 shadowRayDir = sample - hitPoint;							
+				Lightmap& lightmap = _scene->lightmaps[id];
+				lightmap.begin( subdivisions );
 
-					float distance = shadowRayDir.length();
+				const vector3 normal = triangle->getNormal();
 
-					shadowRayDir.normalize();
+				for ( uint32 i = 0; i <= subdivisions; ++i )
+				{
+					for ( uint32 j = 0; i + j <= subdivisions; ++j )
+					{
+						const vector3 point = triangle->a() + triangle->edge1() * ( static_cast<float>( i ) / subdivisions )
+															+ triangle->edge2() * ( static_cast<float>( j ) / subdivisions );
 
-					float tmax = distance - EPSILON;
-					float tmin = EPSILON;
-						
-					Ray shadowRay( hitPoint, shadowRayDir, tmin, tmax );	
+						rgb direct, area;
 
+						for ( uint32 l = 0; l < _scene->lights.size(); ++l )
+						{
+							const vector3 lightPos	= _scene->lights[l]->getPosition();
+							const float intensity	= math::vec::scalarProduct( normal, ( lightPos - point ).normalize() );
 
-					//////////////////////////
+							if ( intensity <= 0.0f )
+								continue;
 
-					float intensity = math::vec::scalarProduct( hitNormal, shadowRayDir );
-					if ( intensity > 0.0f )
-					{					
-						const vector3	lightDir	= (hitPoint - sample).normalize();
-															
-						Ray lightRay( sample, lightDir, EPSILON, (sample-hitPoint).length() - EPSILON );					
+							Ray lightRay = pointLightRay( lightPos, point );
+							if ( !isInShadow( &lightRay, NO_PRIMITIVE, l ) )
+								direct += intensity * _scene->lights[l]->getColor();
+						}
 
-						if (isInShadow(&lightRay))
-							continue;
+						for ( std::vector<AreaLight*>::iterator it = _scene->areaLights.begin(); it != _scene->areaLights.end(); ++it )
+							area += areaLightIrradiance( point, normal, *it, BAKE_AREA_SAMPLES );
 
-						float contrib = math::vec::scalarProduct(areaNormal, -1.0f * shadowRayDir);
-						contrib /= areaLight->getDecline(distance);
-					
-						color += contrib * areaDecline * hitColor * hitDiffuse * intensity * areaColor;
-					}				
+						lightmap.set( i, j, direct, area );
+					}
 				}
 
+				lightmap.end();
+				++baked;
 			}
-			return color;
-		}			
 
-		/// Casts reflected rays
-		/**
-			In case the material is specular, it casts a reflected ray.
+			// the images rendered so far used the old light
+			if ( baked )
+			{
+				++_scene->bakeVersion;
+				++_scene->version;
+			}
 
-			@param		Ray
-			@param		HitInfo[in]	Info structure to describe the intersection of the ray and the scene
-			@return		rgb
+			return baked;
+		}
+
+		/// Drops the lightmaps of the triangles a light at some of the given points can reach
+		/**
+			@param points[in] light positions
+			@param count[in] number of points
 		*/
-		const rgb castReflectedRays( Ray* ray, HitInfo* hitInfo )
+		void invalidateLightmaps( const vector3* points, uint32 count )
 		{
-			float specular = hitInfo->getPrimitive()->getMaterial().specular();
-			if ( specular > 0.0f )
+			for ( uint32 id = 0; id < _scene->lightmaps.size(); ++id )
 			{
-				const vector3 hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
-				const vector3 normal = hitInfo->getNormal();
+				if ( !_scene->lightmaps[id].isValid() )
+					continue;
 
-				vector3 direction = ray->getDirection() - 2.0f * math::vec::scalarProduct( ray->getDirection(), normal) * normal;
-				direction.normalize();						
+				for ( uint32 i = 0; i < count; ++i )
+				{
+					if ( _scene->primitives[id]->canBeLitFrom( points[i] ) )
+					{
+						_scene->lightmaps[id].invalidate();
+						break;
+					}
+				}
+			}
+		}
 
-				Ray reflectedRay(hitPoint + direction * EPSILON, direction);
-				reflectedRay.setDepth( ray->getDepth() + 1 );
+		/// Drops the lightmaps of the triangles an area light can reach
+		void invalidateLightmaps( AreaLight* light )
+		{
+			const Triangle* patch = light->getTriangle();
+			const vector3 corners[3] = { patch->a(), patch->b(), patch->c() };
 
-				return intersectRayWithScene( &reflectedRay, &HitInfo() ) * specular;
-			}
-			return rgb();
+			invalidateLightmaps( corners, 3 );
 		}
 
-		/// Casts refracted rays
+		/// Drops the lightmaps a new primitive can shadow
 		/**
-			In case the material is transmittive (light can go through) it casts a transmittive ray.
+			The primitive can only block light which passes through its bounds, so a lightmap is dropped when
+			the bounds overlap the box around its triangle and one of the lights reaching it.
 
-			@param		Ray[in]
-			@param		HitInfo[in]	Info structure to describe the intersection of the ray and the scene
-			@return		rgb
+			@param occluder[in] new primitive
 		*/
-		const rgb castRefractedRays( Ray* ray, HitInfo* hitInfo )
+		void invalidateOccludedLightmaps( const Primitive* occluder )
 		{
-			float transmittence = hitInfo->getPrimitive()->getMaterial().transmittence();
-			if( transmittence > 0.0f )
-			{					
-				float refraction = hitInfo->getPrimitive()->getMaterial().refraction();
-				const vector3 hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
-				vector3 normal = hitInfo->getNormal();
+			vector3 lower, upper;
+			occluder->getBounds( lower, upper );
 
-				float d = math::vec::scalarProduct(ray->getDirection(), normal);
-				float gamma;
-			
-				if( d < 0.0f )
-				{				
-					gamma = 1.0f / refraction;
-				}
-				else
-				{					
-					gamma = refraction;
-					d = -d;
-					normal = -1.0f * normal;
+			for ( uint32 id = 0; id < _scene->lightmaps.size(); ++id )
+			{
+				if ( !_scene->lightmaps[id].isValid() )
+					continue;
+
+				const Triangle* triangle = static_cast<const Triangle*>( _scene->primitives[id] );
+
+				vector3 boxLower, boxUpper;
+				triangle->getBounds( boxLower, boxUpper );
+
+				bool shadowed = false;
+
+				for ( uint32 l = 0; l < _scene->lights.size() && !shadowed; ++l )
+				{
+					const vector3 position = _scene->lights[l]->getPosition();
+					shadowed = triangle->canBeLitFrom( position ) && overlaps( lower, upper, boxLower, boxUpper, &position, 1 );
 				}
 
-				float sqrterm = 1.0f - gamma * gamma * (1.0f - d * d);
+				for ( uint32 l = 0; l < _scene->areaLights.size() && !shadowed; ++l )
+				{
+					const Triangle* patch = _scene->areaLights[l]->getTriangle();
+					if ( patch == occluder )
+						continue;
 
-				sqrterm = d * gamma + sqrtf(sqrterm);
-					
-				uint32 depth = ray->getDepth() + 1;
-				vector3 direction = -sqrterm * normal + ray->getDirection() * gamma;
-				vector3 origin = hitPoint + direction * EPSILON;								
-					
-				Ray refractedRay(origin, direction);
-				refractedRay.setDepth(depth);
+					const vector3 corners[3] = { patch->a(), patch->b(), patch->c() };
+
+					shadowed = ( triangle->canBeLitFrom( corners[0] ) || triangle->canBeLitFrom( corners[1] ) || triangle->canBeLitFrom( corners[2] ) )
+							&& overlaps( lower, upper, boxLower, boxUpper, corners, 3 );
+				}
 
-				return intersectRayWithScene( &refractedRay, &HitInfo() ) * transmittence;
+				if ( shadowed )
+					_scene->lightmaps[id].invalidate();
 			}
-			return rgb();
 		}
 
-		/// Checks if hit is in shadow
+		/// Checks whether a box overlaps the bounds of another box extended by some points
+		static bool overlaps( vector3 const& lower, vector3 const& upper, vector3 boxLower, vector3 boxUpper, const vector3* points, uint32 count )
+		{
+			for ( uint32 i = 0; i < count; ++i )
+			{
+				boxLower = vector3( std::min( boxLower.x(), points[i].x() ), std::min( boxLower.y(), points[i].y() ), std::min( boxLower.z(), points[i].z() ) );
+				boxUpper = vector3( std::max( boxUpper.x(), points[i].x() ), std::max( boxUpper.y(), points[i].y() ), std::max( boxUpper.z(), points[i].z() ) );
+			}
+
+			return lower.x() <= boxUpper.x() && upper.x() >= boxLower.x()
+				&& lower.y() <= boxUpper.y() && upper.y() >= boxLower.y()
+				&& lower.z() <= boxUpper.z() && upper.z() >= boxLower.z();
+		}
+
+		/// Checks whether the diffuse light of a primitive can be read from its lightmap
 		/**
-			Functions similarly to intersectWithScene, although without any overhead. A ray is given with
-			origin inside hitpoint and range limited to light distance. Then it checks if it hits something
-			along the way. If it does, the hit point is inside a shadow.
+			Highlights need the visibility of the lights anyway, so only triangles without one use the baked
+			point lights.
+		*/
+		bool hasBakedDiffuse( const Primitive* primitive ) const
+		{
+			if ( !_useBakedLighting || primitive->getId() >= _scene->lightmaps.size() || !_scene->lightmaps[primitive->getId()].isValid() )
+				return false;
+
+			const material m = primitive->getMaterial();
+			return m.shine() <= 0.0f || m.specular() <= 0.0f;
+		}
 
+		/// Baked irradiance at a hit
+		/**
 			@param ray[in] ray
 			@param hitInfo[in] hit result
-			@return bool
+			@param direct[out] irradiance of the point lights
+			@param area[out] irradiance of the area lights
+			@return false when the hit primitive isn't baked
 		*/
-		bool isInShadow( Ray* ray )
-		{						
-			for ( std::vector< Primitive* >::iterator it = _primitives.begin(); it != _primitives.end(); ++it )
-			{	
-				// we cast the ray at every primitive (sphere, triangle) in the scene
-				// and see what happens
-				Primitive* primitive = *it;
-				if ( primitive->intersect( ray ) )										
-					return true;				
-			}
-			return false;			
+		bool lookupBaked( Ray* ray, HitInfo* hitInfo, rgb& direct, rgb& area ) const
+		{
+			const uint32 id = hitInfo->getPrimitive()->getId();
+
+			if ( !_useBakedLighting || id >= _scene->lightmaps.size() || !_scene->lightmaps[id].isValid() )
+				return false;
+
+			// only triangles have lightmaps
+			const Triangle* triangle = static_cast<const Triangle*>( hitInfo->getPrimitive() );
+
+			float u, v;
+			triangle->barycentric( ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() ), u, v );
+
+			_scene->lightmaps[id].lookup( u, v, direct, area );
+			return true;
 		}
 
-		/// Phong shader
+		/// Primitives whose shading can change when a light at some of the given points changes
 		/**
-			Based on given hit info and ray parameters, calculates a resulting color. Both diffuse and shiny.
-			contributions.
+			See Primitive::canBeLitFrom. Reflective and transmissive primitives are always included, they can show the change wherever it happens. Area
+			light patches aren't shaded, the caller adds the edited one.
 
-			@param ray[in] ray
-			@param hitInfo[in] hit result
-			@return const color
+			@param points[in] light positions, the corners of an area light
+			@param count[in] number of points
+			@param primitives[out] affected primitives are appended
 		*/
-		const rgb shade( Ray* ray, HitInfo* hitInfo )
+		void findLitPrimitives( const vector3* points, uint32 count, std::vector<Primitive*>& primitives ) const
 		{
-			rgb color; // initial color vector : #000000
-			
-			const Primitive*	primitive	= hitInfo->getPrimitive();			
-			const vector3		hitPoint	= ray->getOrigin() + ( ray->getDirection() * hitInfo->getDistance() );
-			const material		material	= primitive->getMaterial();			
-
-			// contribution of every light source
-			for ( std::vector<PointLight*>::iterator it = _lights.begin(); it != _lights.end(); ++it )
+			for ( std::vector<Primitive*>::const_iterator it = _scene->primitives.begin(); it != _scene->primitives.end(); ++it )
 			{
-				PointLight* light = *it;
+				Primitive* primitive = *it;
 
-				const vector3	hitNormal	= hitInfo->getNormal();				
-				const vector3	lightPos	= light->getPosition();
-				const vector3	shadowDir	= (lightPos - hitPoint).normalize();
+				if ( primitive->isLight() )
+					continue;
 
-				float intensity = math::vec::scalarProduct( hitNormal, shadowDir );
+				const material m = primitive->getMaterial();
+				bool lit = m.specular() > 0.0f || m.transmittence() > 0.0f;
 
-				if ( intensity > 0.0f )
-				{
-					const rgb		lightColor	= light->getColor();
-					const vector3	lightDir	= (hitPoint - lightPos).normalize();
-															
-					Ray lightRay( lightPos, lightDir, 0.0f, (lightPos-hitPoint).length() - EPSILON );					
+				for ( uint32 i = 0; i < count && !lit; ++i )
+					lit = primitive->canBeLitFrom( points[i] );
 
-					if (isInShadow(&lightRay))
-						continue;
-					
-					color += material.color() * material.diffuse() * intensity * lightColor;
+				if ( lit )
+					primitives.push_back( primitive );
+			}
+		}
 
-					// specular
-					if ( material.shine() > 0.0f )
-					{
-						vector3 shineDir = shadowDir - ( 2.0f * math::vec::scalarProduct( shadowDir, hitNormal ) * hitNormal );				
-						intensity = math::vec::scalarProduct( shineDir, ray->getDirection() );				
-						intensity = pow( intensity, material.shine() );					
-						intensity = std::min( intensity, 10000.0f );
+		/// Triangle of an area light
+		Triangle* getAreaLightTriangle( uint32 index ) const
+		{ return _scene->areaLights[index]->getTriangle(); }
 
-						color += material.specular() * intensity * lightColor;
-					}
-				}
-								
+		AreaLight const* getAreaLight( uint32 index ) const
+		{ return _scene->areaLights[index]; }
+
+		/// Adds the lights and the shading settings to the hash of a frame, see Context::frameKey
+		void hashState( ContentHash& hash ) const
+		{
+			for ( std::vector<PointLight*>::const_iterator it = _scene->lights.begin(); it != _scene->lights.end(); ++it )
+			{
+				hash.add( (*it)->getPosition() );
+				hash.add( (*it)->getColor() );
 			}
-			return color;
+
+			for ( std::vector<AreaLight*>::const_iterator it = _scene->areaLights.begin(); it != _scene->areaLights.end(); ++it )
+				hash.add( (*it)->getEmissiveMaterial() );
+
+			hash.add( _background );
+			hash.add( &_emBgHash, sizeof( _emBgHash ) );
+
+			hash.add( _lightSamples );
+			hash.add( _areaLightSamples );
+			hash.add( static_cast<uint32>( _useIrradianceCache ) | static_cast<uint32>( _fastShading ) << 1 | static_cast<uint32>( _useBakedLighting ) << 2 );
+			hash.add( _scene->bakeVersion );
 		}
 
+		/// Number of changes of the scene or its lights so far
+		uint32 getSceneVersion() const
+		{ return _scene->version; }
+
+		/// Sets the number of shadow rays per area light and hit
+		/**
+			Fewer samples give noisier soft shadows, which the denoiser can smooth.
+		*/
+		void setAreaLightSamples( uint32 samples )
+		{ _areaLightSamples = samples; }
+
+		uint32 getAreaLightSamples() const
+		{ return _areaLightSamples; }
+
+		bool usesIrradianceCache() const
+		{ return _useIrradianceCache; }
+
+		bool samplesLights() const
+		{ return _lightSamples != 0; }
+
+		/// Checks whether packets can be cast from more threads at once
+		/**
+			The irradiance cache and path recording modify shared state while shading.
+		*/
+		bool isThreadSafe() const
+		{ return !_useIrradianceCache && !_pathRecorder; }
+
+		/// Sets the number of lights sampled per hit
+		/**
+			@param count[in] lights picked at random per hit, 0 evaluates all the lights
+		*/
+		void setLightSamples( uint32 count )
+		{ _lightSamples = count; }
+
 		void setInverseMatrix( matrix4x4 const& matrix )
 		{
 			_inverseMVP = matrix;
+			_rayGenerator.setup( _inverseMVP, _viewport );
 		}
 
 		void setViewportMatrix( viewport viewport, matrix4x4 const& matrix )
 		{
 			_viewportM = matrix;
 			_viewport = viewport;
+			_rayGenerator.setup( _inverseMVP, _viewport );
 		}
 
 		void setBackground( rgb background )
@@ -383,33 +2131,72 @@ class RayTracer
 		rgb getBackround() const
 		{ return _background; }	
 
+		/// Adds an area light
+		/**
+			The light's triangle is added to the scene primitives as well, tagged by its emissive material.
+		*/
 		void addAreaLight(AreaLight* light)
 		{
-			_areaLights.push_back(light);
+			light->setIndex(_scene->areaLights.size());
+			_scene->areaLights.push_back(light);
+			addPrimitive(light->getTriangle());
+			invalidateLightmaps(light);
 		}
 
+		/// Sets the environment map, the texels are kept by the caller
+		/**
+			The map is hashed for the frame cache here, see hashState, so edits of the texels only count
+			after the map is set again.
+		*/
 		void setEmBackground( float const& w, float const& h, float* texture )
 		{ 
 			_emBgW = w;
 			_emBgH = w;
 			_emBg = texture;
+
+			ContentHash hash;
+			hash.add( w );
+			hash.add( h );
+			if ( texture )
+				hash.add( texture, static_cast<uint32>( w * h * 3 * sizeof( float ) ) );
+			_emBgHash = hash.value();
 		}
 
 
 	private:
-		std::vector<PointLight*>	_lights;
-		std::vector<AreaLight*>		_areaLights;
-
-		std::vector<Primitive*>		_primitives;		
+		Scene*						_scene;
 
 		matrix4x4					_inverseMVP;
 		matrix4x4					_viewportM;
 		viewport					_viewport;
+		RayGenerator				_rayGenerator;
 
 		rgb							_background;
 
 		float _emBgW, _emBgH;
 		float * _emBg;
+		uint64 _emBgHash;			///< dimensions and texels, see setEmBackground
+
+		uint32						_lightSamples;
+
+		bool						_useIrradianceCache;
+
+		bool						_fastShading;
+		uint32						_areaLightSamples;
+
+		bool						_useBakedLighting;
+
+		std::vector<pathNode>*		_pathRecorder;		///< NULL unless recording, see recordPaths
+		float						_pathWeight;		///< weight of the hits of the traced ray
+
+		std::vector<uint8>			_shadowHints;
+		uint32						_shadowHintPrimitive;
+
+		// per thread
+		std::vector<sglRenderStats>			_threadStats;
+		std::vector< std::vector<uint32> >	_occluderCache;
+		std::vector<RandomGenerator>		_random;
+		uint32								_frame;		///< renders so far, part of the random seeds
 
 		Context*					_context;
 };
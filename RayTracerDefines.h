@@ -4,6 +4,76 @@
 const float EPSILON = 1e-1f;
 const uint32 MAX_RAY_DEPTH = 8;
 const uint32 AREA_LIGHT_SAMPLES = 16;
+const uint32 NO_PRIMITIVE = std::numeric_limits<uint32>::max();
+const uint32 NO_LIGHT = std::numeric_limits<uint32>::max();
+const uint32 OCCLUDER_CACHE_SIZE = 4;				///< recent occluders remembered per light and thread
+const uint32 MAX_SQUARING_SHINE = 256;				///< integer Phong exponents up to this use exponentiation by squaring
+
+// shadow sharing
+const uint32 SHADOW_LATTICE_STRIDE = 8;				///< pixels between lattice points
+const uint32 SHADOW_LATTICE_STRIDE_CONSERVATIVE = 2;
+const uint32 SHADOW_UNKNOWN_ID = NO_PRIMITIVE - 1;	///< lattice point facing away from the light
+
+enum shadowHint
+{
+	SHADOW_UNKNOWN,
+	SHADOW_LIT,
+	SHADOW_OCCLUDED
+};
+
+// irradiance cache
+const float IRRADIANCE_CACHE_ACCURACY = 4.0f;		///< inverse of the allowed error, records reach radius / accuracy
+const uint32 IRRADIANCE_CACHE_SAMPLES = 64;			///< shadow rays per light when computing a record
+const uint32 IRRADIANCE_CACHE_BUCKETS = 65536;
+const float IRRADIANCE_CACHE_MIN_RADIUS = 1e-3f;
+const float IRRADIANCE_CACHE_PENUMBRA_SCALE = 0.1f;	///< shrinks records inside soft shadows
+
+// baked lighting
+const float BAKE_RESOLUTION = 128.0f;				///< lightmap corners along the diagonal of the scene bounds
+const uint32 BAKE_MAX_SUBDIVISIONS = 64;			///< lightmap resolution limit along a triangle edge
+const uint32 BAKE_AREA_SAMPLES = 64;				///< shadow rays per area light and lightmap corner
+
+// deadline render
+const uint32 DEADLINE_COARSE_STRIDE = 4;			///< pixels between the samples of the coarse pass
+const uint32 DEADLINE_AREA_SAMPLES = 4;				///< area light samples before the refinement stage
+
+// dynamic resolution
+const float DYNAMIC_RESOLUTION_MIN_SCALE = 0.25f;	///< smallest scale of the width and height
+
+// temporal reuse
+const uint32 TEMPORAL_MAX_AGE = 8;					///< frames a reprojected color is reused before it's traced again
+const float TEMPORAL_POSITION_TOLERANCE = 0.01f;	///< distance of the reprojected and the new hit, relative to the hit distance
+
+// frame cache
+const uint32 FRAME_CACHE_SIZE = 8;					///< rendered images kept by SGL_FRAME_CACHE
+
+// dirty regions
+const uint32 DIRTY_TILE_SIZE = 16;					///< light edits re-trace squares of this many pixels
+
+// multiple views
+const uint32 VIEW_TILE_SIZE = 32;					///< squares of pixels the threads trace in sglRayTraceViews
+
+// ray queries
+const uint32 RAY_QUERY_CHUNK = 1024;				///< rays a thread takes at once in sglIntersectRays and sglOccludeRays
+
+// culling
+const uint32 CULL_CLUSTER_SIZE = 16;				///< consecutive primitives sharing a bounding sphere
+
+// shadow maps
+const uint32 SHADOW_MAP_SIZE = 256;					///< pixels along the edge of a cube map face
+const uint32 AREA_SHADOW_SAMPLES = 4;				///< cube maps per area light, see AreaLight::getShadowSample
+const float SHADOW_MAP_BIAS = 0.01f;				///< depth a lit surface may lie behind the map, relative to its distance
+const float SHADOW_MAP_NORMAL_OFFSET = 1.5f;		///< texels a surface is pushed along its normal before the lookup
+
+// coarse-to-fine preview
+const uint32 PREVIEW_START_STRIDE = 8;				///< pixels between the samples of the first level, a power of two
+const float PREVIEW_COLOR_THRESHOLD = 0.05f;		///< corners closer than this in every channel are interpolated
+
+// denoiser
+const uint32 DENOISE_ITERATIONS = 3;				///< the widest kernel spans 2^(iterations + 1) pixels
+const float DENOISE_SIGMA_COLOR = 0.1f;				///< luminance difference of the first iteration
+const float DENOISE_SIGMA_DEPTH = 0.02f;			///< relative depth difference per pixel of distance
+const uint32 DENOISE_NORMAL_POWER = 32;
 
 const rgb WHITE( 1.0f, 1.0f, 1.0f );
 const rgb BLACK( 0.0f, 0.0f, 0.0f );
@@ -13,6 +83,20 @@ const rgb BLUE( 0.0f, 0.0f, 1.0f );
 
 // #define _TRIANGLE_CULLING
 
+/// Material classes, selecting compile-time specialized shading kernels
+/**
+	Diffuse-only materials are MATERIAL_DIFFUSE, mirrors MATERIAL_REFLECTIVE, glossy materials add
+	MATERIAL_HIGHLIGHT and glass MATERIAL_TRANSMISSIVE.
+*/
+enum materialClass
+{
+	MATERIAL_DIFFUSE		= 0,
+	MATERIAL_HIGHLIGHT		= 1,	///< Phong highlight, shine > 0 and ks > 0
+	MATERIAL_REFLECTIVE		= 2,	///< reflected rays, ks > 0
+	MATERIAL_TRANSMISSIVE	= 4,	///< refracted rays, T > 0
+	MATERIAL_GENERIC		= 8		///< not classified yet, all the features are checked at runtime
+};
+
 struct material
 {
 	public:
@@ -0,0 +1,139 @@
+#ifndef __RELIGHT_CACHE_H__
+#define __RELIGHT_CACHE_H__
+
+#include <vector>
+#include <utility>
+
+/// A hit along the path of a pixel, recorded for relighting
+/**
+	The color of a pixel is the weighted sum of the light reaching the hits along its primary, reflected and
+	refracted rays. Geometry doesn't change when only lights do, so the hits and their weights can be reused
+	and only the light has to be evaluated again.
+*/
+struct pathNode
+{
+	public:
+		pathNode()
+			: weight(1.0f)
+		{ }
+
+		Ray		ray;
+		HitInfo	hitInfo;	///< no primitive for a ray which missed the scene
+		float	weight;		///< product of the ks and T factors along the path
+
+		rgb		direct;		///< point lights
+		rgb		area;		///< area lights
+};
+
+/// Edited point lights along with their state the cache was shaded with
+typedef std::vector< std::pair<uint32, PointLight> > pointLightEdits;
+
+/// Paths of all the pixels of the last render
+class RelightCache
+{
+	public:
+		RelightCache()
+			: _valid(false), _w(0), _h(0), _sceneVersion(0), _areaLightsEdited(false)
+		{ }
+
+		/// Starts recording a new render
+		void begin( uint32 w, uint32 h, matrix4x4 const& mvp )
+		{
+			_w = w;
+			_h = h;
+			_mvp = mvp;
+			_valid = false;
+
+			_nodes.clear();
+			_offsets.assign( 1, 0 );
+			clearEdits();
+		}
+
+		/// Closes the nodes of the next pixel, pixels go row by row
+		void endPixel()
+		{ _offsets.push_back( _nodes.size() ); }
+
+		/// Marks the recorded render complete
+		/**
+			@param sceneVersion[in] version of the scene the render saw, see RayTracer::getSceneVersion
+		*/
+		void end( uint32 sceneVersion )
+		{
+			_sceneVersion = sceneVersion;
+			_valid = true;
+		}
+
+		/// Light edits keep the cache valid, the edited lights are reshaded
+		void update( uint32 sceneVersion )
+		{ _sceneVersion = sceneVersion; }
+
+		void invalidate()
+		{ _valid = false; }
+
+		/// Checks whether the recorded paths still match the scene and the camera
+		bool isValid( uint32 w, uint32 h, matrix4x4 const& mvp, uint32 sceneVersion ) const
+		{
+			if ( !_valid || w != _w || h != _h || sceneVersion != _sceneVersion )
+				return false;
+
+			for ( uint32 i = 0; i < 16; ++i )
+				if ( mvp[i] != _mvp[i] )
+					return false;
+
+			return true;
+		}
+
+		bool isValid( uint32 sceneVersion ) const
+		{ return _valid && sceneVersion == _sceneVersion; }
+
+		/// Remembers a point light before its edit, only the first edit since the last render counts
+		void editPointLight( uint32 index, PointLight const& old )
+		{
+			for ( pointLightEdits::const_iterator it = _pointLightEdits.begin(); it != _pointLightEdits.end(); ++it )
+				if ( it->first == index )
+					return;
+
+			_pointLightEdits.push_back( std::make_pair( index, old ) );
+		}
+
+		void editAreaLight()
+		{ _areaLightsEdited = true; }
+
+		pointLightEdits const& getPointLightEdits() const
+		{ return _pointLightEdits; }
+
+		bool areaLightsEdited() const
+		{ return _areaLightsEdited; }
+
+		/// Called once the nodes were relit
+		void clearEdits()
+		{
+			_pointLightEdits.clear();
+			_areaLightsEdited = false;
+		}
+
+		/// Nodes are appended here while a pixel is traced
+		std::vector<pathNode>& nodes()
+		{ return _nodes; }
+
+		/// Nodes of a pixel are [firstNode(i), lastNode(i))
+		uint32 firstNode( uint32 pixel ) const
+		{ return _offsets[pixel]; }
+
+		uint32 lastNode( uint32 pixel ) const
+		{ return _offsets[pixel + 1]; }
+
+	private:
+		bool					_valid;
+		uint32					_w, _h;
+		matrix4x4				_mvp;
+		uint32					_sceneVersion;
+
+		std::vector<pathNode>	_nodes;
+		std::vector<uint32>		_offsets;
+
+		pointLightEdits			_pointLightEdits;
+		bool					_areaLightsEdited;
+};
+
+#endif
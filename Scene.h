@@ -0,0 +1,67 @@
+#ifndef __SCENE_H__
+#define __SCENE_H__
+
+#include <vector>
+
+/// Geometry and lights of a scene, shared by the contexts rendering it
+/**
+	Holds everything derived from the scene alone: the primitives and lights, the culling clusters and
+	material classes built by RayTracer::prepareScene, the lightmaps and the irradiance cache. The camera,
+	the render modes and the per-thread caches stay in the RayTracer of every context, see
+	RayTracer::attachScene.
+
+	A scene is reference counted, it's created with one reference and deleted together with its
+	primitives and lights when the last one is released.
+*/
+class Scene
+{
+	public:
+		Scene()
+			: version(0), bakeVersion(0), lightCdfVersion(0), _references(1)
+		{ }
+
+		~Scene()
+		{
+			// area light patches are among the primitives
+			for ( std::vector<Primitive*>::iterator it = primitives.begin(); it != primitives.end(); ++it )
+				delete *it;
+			for ( std::vector<PointLight*>::iterator it = lights.begin(); it != lights.end(); ++it )
+				delete *it;
+			for ( std::vector<AreaLight*>::iterator it = areaLights.begin(); it != areaLights.end(); ++it )
+				delete *it;
+		}
+
+		void retain()
+		{ ++_references; }
+
+		/// Drops a reference, the scene is deleted with the last one
+		void release()
+		{
+			if ( !--_references )
+				delete this;
+		}
+
+		std::vector<PointLight*>		lights;
+		std::vector<AreaLight*>			areaLights;
+
+		std::vector<Primitive*>			primitives;		///< indexed by primitive id
+		std::vector<primitiveCluster>	clusters;
+
+		IrradianceCache					irradianceCache;
+		std::vector<Lightmap>			lightmaps;		///< indexed by primitive id, only triangles are baked
+
+		ContentHash						hash;			///< geometry and materials, in the order they were added
+		uint32							version;		///< bumped by every change of the geometry or lights
+		uint32							bakeVersion;	///< number of bakes which changed a lightmap
+
+		std::vector<float>				lightCdf;		///< cumulative power of the lights, see RayTracer::updateLightCdf
+		uint32							lightCdfVersion;	///< version the lightCdf was built for
+
+	private:
+		Scene( Scene const& );
+		Scene& operator=( Scene const& );
+
+		uint32							_references;
+};
+
+#endif
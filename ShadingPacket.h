@@ -0,0 +1,79 @@
+#ifndef __SHADING_PACKET_H__
+#define __SHADING_PACKET_H__
+
+/// Primary hits of a ray packet in a SoA layout
+/**
+	Holds everything the point light shader needs, so that a light can be evaluated for all
+	RAY_PACKET_SIZE hits at once. Material parameters are gathered when a lane is set.
+*/
+struct hitPacket
+{
+	public:
+		/// All lanes empty
+		/**
+			The AVX shaders load every lane and mask the results afterwards, the unused lanes hold zeros so
+			that no arithmetic runs on uninitialized floats.
+		*/
+		hitPacket() : mask(0)
+		{
+			for ( uint32 i = 0; i < RAY_PACKET_SIZE; ++i )
+			{
+				px[i] = py[i] = pz[i] = 0.0f;
+				nx[i] = ny[i] = nz[i] = 0.0f;
+				vx[i] = vy[i] = vz[i] = 0.0f;
+
+				materials[i] = 0;
+				kr[i] = kg[i] = kb[i] = 0.0f;
+				ks[i] = shine[i] = 0.0f;
+			}
+		}
+
+		/// Fills a lane
+		/**
+			@param i[in] lane
+			@param point[in] hit position
+			@param normal[in] surface normal
+			@param direction[in] direction of the ray which hit
+			@param materialIndex[in] index of the material, the id of the hit primitive
+			@param m[in] material
+		*/
+		void set( uint32 i, vector3 const& point, vector3 const& normal, vector3 const& direction, uint32 materialIndex, material const& m )
+		{
+			px[i] = point.x();		py[i] = point.y();		pz[i] = point.z();
+			nx[i] = normal.x();		ny[i] = normal.y();		nz[i] = normal.z();
+			vx[i] = direction.x();	vy[i] = direction.y();	vz[i] = direction.z();
+
+			materials[i] = materialIndex;
+
+			const rgb diffuse = m.color() * m.diffuse();
+			kr[i] = diffuse.red();	kg[i] = diffuse.green();	kb[i] = diffuse.blue();
+			ks[i] = m.specular();
+			shine[i] = m.shine();
+
+			mask |= 1u << i;
+		}
+
+		float	px[RAY_PACKET_SIZE], py[RAY_PACKET_SIZE], pz[RAY_PACKET_SIZE];	///< hit positions
+		float	nx[RAY_PACKET_SIZE], ny[RAY_PACKET_SIZE], nz[RAY_PACKET_SIZE];	///< normals
+		float	vx[RAY_PACKET_SIZE], vy[RAY_PACKET_SIZE], vz[RAY_PACKET_SIZE];	///< ray directions
+
+		uint32	materials[RAY_PACKET_SIZE];										///< material indices
+		float	kr[RAY_PACKET_SIZE], kg[RAY_PACKET_SIZE], kb[RAY_PACKET_SIZE];	///< color * diffuse
+		float	ks[RAY_PACKET_SIZE], shine[RAY_PACKET_SIZE];
+
+		uint32	mask;															///< bit per valid lane
+};
+
+/// Shadow rays of a hit packet towards one light
+struct shadowPacket
+{
+	public:
+		Ray ray( uint32 i ) const
+		{ return Ray( vector3( rays.ox[i], rays.oy[i], rays.oz[i] ), vector3( rays.dx[i], rays.dy[i], rays.dz[i] ), 0.0f, tmax[i] ); }
+
+		rayPacket	rays;					///< from the light towards the hits
+		float		tmax[RAY_PACKET_SIZE];
+		uint32		mask;					///< bit per lane facing the light
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef __SHADOW_MAP_H__
+#define __SHADOW_MAP_H__
+
+#include <vector>
+
+/// Depth of the scene seen from a point through the six faces of a cube
+/**
+	Every face is a 90 degree perspective view along one of the axes, rendered by the context rasterizer,
+	see Context::renderShadowMap. The faces hold the normalized device z of the closest surface.
+*/
+class CubeShadowMap
+{
+	public:
+		CubeShadowMap()
+			: _key(0), _size(0), _near(0.0f), _far(0.0f)
+		{ }
+
+		/// Clears the faces for a new point
+		/**
+			@param position[in] point the map is seen from
+			@param range[in] distance of the farthest surface
+			@param size[in] pixels along the edge of a face
+			@param key[in] hash of everything the map is rendered from
+		*/
+		void begin( vector3 const& position, float range, uint32 size, uint64 key )
+		{
+			_position	= position;
+			_size		= size;
+			_key		= key;
+
+			// the depth resolution only suffers close to the near plane
+			_far	= std::max( range, EPSILON ) * 1.01f;
+			_near	= _far * 1e-3f;
+
+			_depth.assign( 6 * size * size, Z_BUFFER_INFINITY );
+		}
+
+		/// Maps the world to the clip space of a face
+		/**
+			@param face[in] +X, -X, +Y, -Y, +Z, -Z
+		*/
+		matrix4x4 getFaceMatrix( uint32 face ) const
+		{
+			vector3 forward, right, up;
+			faceAxes( face, forward, right, up );
+
+			const float a = ( _far + _near ) / ( _far - _near );
+			const float b = -2.0f * _far * _near / ( _far - _near );
+
+			matrix4x4 m;
+			setRow( m, 0, right, 0.0f );
+			setRow( m, 1, up, 0.0f );
+			setRow( m, 2, a * forward, b );
+			setRow( m, 3, forward, 0.0f );
+
+			return m;
+		}
+
+		float* getFace( uint32 face )
+		{ return &_depth[face * _size * _size]; }
+
+		uint32 getSize() const
+		{ return _size; }
+
+		uint64 getKey() const
+		{ return _key; }
+
+		vector3 const& getPosition() const
+		{ return _position; }
+
+		/// Checks whether a surface point sees the center of the map
+		/**
+			The point is pushed along the normal by the footprint of a texel and its depth may exceed the stored
+			one by SHADOW_MAP_BIAS, so surfaces don't shadow themselves.
+
+			@param point[in] point on a surface
+			@param normal[in] normal of the surface, facing the center of the map
+			@return false when a surface closer to the center covers the point
+		*/
+		bool isLit( vector3 const& point, vector3 const& normal ) const
+		{
+			if ( !_size )
+				return true;
+
+			vector3 toPoint = point - _position;
+
+			const float texel = 2.0f * toPoint.length() / _size;
+			toPoint = toPoint + normal * ( texel * SHADOW_MAP_NORMAL_OFFSET );
+
+			const uint32 face = majorFace( toPoint );
+
+			vector3 forward, right, up;
+			faceAxes( face, forward, right, up );
+
+			const float depth = math::vec::scalarProduct( forward, toPoint );
+			if ( depth <= _near )
+				return true;
+
+			// the mapping of the viewport, see rasterizeTriangle
+			const float u = ( math::vec::scalarProduct( right, toPoint ) / depth + 1.0f ) * 0.5f * _size;
+			const float v = ( math::vec::scalarProduct( up, toPoint ) / depth + 1.0f ) * 0.5f * _size;
+
+			const uint32 x = std::min( static_cast<uint32>( std::max( u, 0.0f ) ), _size - 1 );
+			const uint32 y = std::min( static_cast<uint32>( std::max( v, 0.0f ) ), _size - 1 );
+
+			const float stored = _depth[( face * _size + y ) * _size + x];
+			if ( stored == Z_BUFFER_INFINITY )
+				return true;
+
+			// back from the normalized device z
+			const float a = ( _far + _near ) / ( _far - _near );
+			const float b = -2.0f * _far * _near / ( _far - _near );
+
+			return depth <= b / ( stored - a ) * ( 1.0f + SHADOW_MAP_BIAS );
+		}
+
+	private:
+		/// Face looking along the largest coordinate of a direction
+		static uint32 majorFace( vector3 const& d )
+		{
+			const float x = std::abs( d.x() ), y = std::abs( d.y() ), z = std::abs( d.z() );
+
+			if ( x >= y && x >= z )
+				return d.x() >= 0.0f ? 0 : 1;
+			if ( y >= z )
+				return d.y() >= 0.0f ? 2 : 3;
+			return d.z() >= 0.0f ? 4 : 5;
+		}
+
+		static void faceAxes( uint32 face, vector3& forward, vector3& right, vector3& up )
+		{
+			const float sign = ( face & 1 ) ? -1.0f : 1.0f;
+
+			switch ( face / 2 )
+			{
+				case 0:
+					forward = vector3( sign, 0.0f, 0.0f );
+					right	= vector3( 0.0f, 0.0f, -sign );
+					up		= vector3( 0.0f, 1.0f, 0.0f );
+					break;
+				case 1:
+					forward = vector3( 0.0f, sign, 0.0f );
+					right	= vector3( 1.0f, 0.0f, 0.0f );
+					up		= vector3( 0.0f, 0.0f, -sign );
+					break;
+				default:
+					forward = vector3( 0.0f, 0.0f, sign );
+					right	= vector3( sign, 0.0f, 0.0f );
+					up		= vector3( 0.0f, 1.0f, 0.0f );
+					break;
+			}
+		}
+
+		/// Row of a matrix acting on points relative to the center of the map
+		void setRow( matrix4x4& m, uint32 row, vector3 const& axis, float offset ) const
+		{
+			m[row * 4 + 0] = axis.x();
+			m[row * 4 + 1] = axis.y();
+			m[row * 4 + 2] = axis.z();
+			m[row * 4 + 3] = offset - math::vec::scalarProduct( axis, _position );
+		}
+
+		uint64				_key;
+		vector3				_position;
+		uint32				_size;
+		float				_near, _far;
+
+		std::vector<float>	_depth;		///< the faces one after another, rows from the bottom
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef __TEMPORAL_HISTORY_H__
+#define __TEMPORAL_HISTORY_H__
+
+#include <vector>
+
+/// Shaded primary hit of a pixel kept for the following frames
+struct historySample
+{
+	public:
+		historySample()
+			: primitiveId(NO_PRIMITIVE), age(0)
+		{ }
+
+		vector3	position;		///< world position of the hit
+		rgb		color;
+		uint32	primitiveId;	///< NO_PRIMITIVE when the pixel holds no history
+		uint32	age;			///< frames since the sample was traced
+};
+
+/// Shaded pixels of the previous frame, reprojected into the current one
+/**
+	Every pixel of the previous frame is moved to the pixel where the new camera sees its world position,
+	the closest one wins when more of them land on the same pixel. Pixels nobody landed on (disocclusions,
+	new parts of the screen) stay empty.
+*/
+class TemporalHistory
+{
+	public:
+		TemporalHistory()
+			: _w(0), _h(0), _sceneVersion(0)
+		{ }
+
+		/// Drops all the history
+		/**
+			@param w[in] width
+			@param h[in] height
+			@param sceneVersion[in] version of the scene the following frames are rendered from
+		*/
+		void reset( uint32 w, uint32 h, uint32 sceneVersion )
+		{
+			_w = w;
+			_h = h;
+			_sceneVersion = sceneVersion;
+
+			_frame.assign( w * h, historySample() );
+			_reprojected.assign( w * h, historySample() );
+		}
+
+		/// Checks whether the history can be reused for a new frame
+		bool isValid( uint32 w, uint32 h, uint32 sceneVersion ) const
+		{ return w == _w && h == _h && sceneVersion == _sceneVersion; }
+
+		/// Moves the last frame to the camera of the new one
+		/**
+			@param mvp[in] model-view-projection matrix of the new frame
+			@param vp[in] viewport of the new frame, samples landing outside of it are dropped
+		*/
+		void reproject( matrix4x4 const& mvp, viewport const& vp )
+		{
+			const float x0 = static_cast<float>( vp.offsetX() ), x1 = std::min( x0 + vp.width(), static_cast<float>( _w ) );
+			const float y0 = static_cast<float>( vp.offsetY() ), y1 = std::min( y0 + vp.height(), static_cast<float>( _h ) );
+
+			_reprojected.assign( _w * _h, historySample() );
+			_depth.assign( _w * _h, std::numeric_limits<float>::max() );
+
+			for ( std::vector<historySample>::const_iterator it = _frame.begin(); it != _frame.end(); ++it )
+			{
+				if ( it->primitiveId == NO_PRIMITIVE )
+					continue;
+
+				vertex v( it->position.x(), it->position.y(), it->position.z(), 1.0f );
+				v *= mvp;
+
+				// behind the camera
+				if ( v.w() <= 0.0f )
+					continue;
+
+				// inverse of the mapping of RayGenerator, the viewport offset sits at [-1, -1] of the clip space
+				const float x = ( v.x() / v.w() + 1.0f ) * 0.5f * vp.width() + x0 + 0.5f;
+				const float y = ( v.y() / v.w() + 1.0f ) * 0.5f * vp.height() + y0 + 0.5f;
+				const float z = v.z() / v.w();
+
+				if ( !( x >= x0 && y >= y0 && x < x1 && y < y1 ) )
+					continue;
+
+				const uint32 i = _w * static_cast<uint32>( y ) + static_cast<uint32>( x );
+
+				if ( z < _depth[i] )
+				{
+					_depth[i] = z;
+					_reprojected[i] = *it;
+				}
+			}
+		}
+
+		/// Reprojected sample of a pixel of the new frame
+		historySample const& reprojected( uint32 x, uint32 y ) const
+		{ return _reprojected[_w * y + x]; }
+
+		/// Stores a pixel of the new frame
+		void store( uint32 x, uint32 y, historySample const& sample )
+		{ _frame[_w * y + x] = sample; }
+
+	private:
+		uint32						_w, _h;
+		uint32						_sceneVersion;
+
+		std::vector<historySample>	_frame;			///< the last rendered frame
+		std::vector<historySample>	_reprojected;
+		std::vector<float>			_depth;
+};
+
+#endif
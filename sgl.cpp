@@ -475,6 +475,54 @@ void sglEnable( sglEEnableFlags cap )
 		case SGL_DEPTH_TEST:
 			cm.currentContext()->enableDepth( true );
 			break;
+
+		case SGL_IRRADIANCE_CACHE:
+			cm.currentContext()->enableIrradianceCache( true );
+			break;
+
+		case SGL_SHADOW_SHARING:
+			cm.currentContext()->enableShadowSharing( true );
+			break;
+
+		case SGL_CONSERVATIVE_SHADOWS:
+			cm.currentContext()->enableConservativeShadows( true );
+			break;
+
+		case SGL_FAST_SHADING:
+			cm.currentContext()->enableFastShading( true );
+			break;
+
+		case SGL_DENOISE:
+			cm.currentContext()->enableDenoise( true );
+			break;
+
+		case SGL_DYNAMIC_RESOLUTION:
+			cm.currentContext()->enableDynamicResolution( true );
+			break;
+
+		case SGL_TEMPORAL_REUSE:
+			cm.currentContext()->enableTemporalReuse( true );
+			break;
+
+		case SGL_RELIGHT_CACHE:
+			cm.currentContext()->enableRelightCache( true );
+			break;
+
+		case SGL_FRAME_CACHE:
+			cm.currentContext()->enableFrameCache( true );
+			break;
+
+		case SGL_HYBRID_RENDER:
+			cm.currentContext()->enableHybridRendering( true );
+			break;
+
+		case SGL_SHADOW_MAPS:
+			cm.currentContext()->enableShadowMaps( true );
+			break;
+
+		case SGL_BAKED_LIGHTING:
+			cm.currentContext()->enableBakedLighting( true );
+			break;
 	}
 }
 
@@ -485,6 +533,54 @@ void sglDisable( sglEEnableFlags cap )
 		case SGL_DEPTH_TEST:
 			cm.currentContext()->enableDepth( false );
 			break;
+
+		case SGL_IRRADIANCE_CACHE:
+			cm.currentContext()->enableIrradianceCache( false );
+			break;
+
+		case SGL_SHADOW_SHARING:
+			cm.currentContext()->enableShadowSharing( false );
+			break;
+
+		case SGL_CONSERVATIVE_SHADOWS:
+			cm.currentContext()->enableConservativeShadows( false );
+			break;
+
+		case SGL_FAST_SHADING:
+			cm.currentContext()->enableFastShading( false );
+			break;
+
+		case SGL_DENOISE:
+			cm.currentContext()->enableDenoise( false );
+			break;
+
+		case SGL_DYNAMIC_RESOLUTION:
+			cm.currentContext()->enableDynamicResolution( false );
+			break;
+
+		case SGL_TEMPORAL_REUSE:
+			cm.currentContext()->enableTemporalReuse( false );
+			break;
+
+		case SGL_RELIGHT_CACHE:
+			cm.currentContext()->enableRelightCache( false );
+			break;
+
+		case SGL_FRAME_CACHE:
+			cm.currentContext()->enableFrameCache( false );
+			break;
+
+		case SGL_HYBRID_RENDER:
+			cm.currentContext()->enableHybridRendering( false );
+			break;
+
+		case SGL_SHADOW_MAPS:
+			cm.currentContext()->enableShadowMaps( false );
+			break;
+
+		case SGL_BAKED_LIGHTING:
+			cm.currentContext()->enableBakedLighting( false );
+			break;
 	}
 }
 
@@ -503,7 +599,7 @@ void sglBeginScene()
 
 void sglEndScene()
 {
-	cm.currentContext()->setSceneDefining( false );
+	cm.currentContext()->endScene();
 }
 
 void sglSphere(const float x,
@@ -564,7 +660,17 @@ void sglRayTraceScene()
 	cc->renderScene();
 }
 
-void sglRasterizeScene() {}
+void sglRasterizeScene()
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	cc->renderSceneRasterized();
+}
 
 void sglEnvironmentMap(const int width,
 					   const int height,
@@ -595,3 +701,321 @@ void sglEmissiveMaterial(
 	cc->setCurrentEmissiveMaterial( r, g, b, c0, c1, c2 );	
 }
 
+
+//---------------------------------------------------------------------------
+// Ray tracing extensions
+//---------------------------------------------------------------------------
+
+void sglLightSampling(const int lightsPerHit)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( lightsPerHit < 0 )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->setLightSampling( static_cast<uint32>(lightsPerHit) );
+}
+
+void sglAreaLightSamples(const int samples)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( samples < 1 )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->setAreaLightSamples( static_cast<uint32>(samples) );
+}
+
+unsigned int sglRayTraceSceneWithin(const float milliseconds)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return 0;
+	}
+
+	if ( milliseconds < 0.0f )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return 0;
+	}
+
+	return cc->renderSceneWithin( milliseconds );
+}
+
+void sglFrameTimeTarget(const float milliseconds)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( milliseconds < 0.0f )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->setFrameTimeTarget( milliseconds );
+}
+
+int sglRayTracePreviewStep(void)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return 0;
+	}
+
+	return static_cast<int>( cc->renderPreviewStep() );
+}
+
+void sglRayTracePreviewReset(void)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	cc->resetPreview();
+}
+
+void sglRayTracePreview(sglPreviewCallback callback, void *userData)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	cc->resetPreview();
+
+	while ( uint32 blockSize = cc->renderPreviewStep() )
+	{
+		if ( callback && callback( static_cast<int>( blockSize ), userData ) )
+			break;
+	}
+}
+
+void sglSetPointLight(const int index, const float x, const float y, const float z, const float r, const float g, const float b)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( index < 0 || static_cast<uint32>( index ) >= cc->getLightCount() )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->setPointLight( index, vector3( x, y, z ), rgb( r, g, b ) );
+}
+
+void sglSetAreaLightEmission(const int index, const float r, const float g, const float b, const float c0, const float c1, const float c2)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( index < 0 || static_cast<uint32>( index ) >= cc->getAreaLightCount() )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->setAreaLightEmission( index, r, g, b, c0, c1, c2 );
+}
+
+void sglRelightScene(void)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	cc->relightScene();
+}
+
+void sglRayTraceRegion(const int x, const int y, const int width, const int height)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( x < 0 || y < 0 || width < 0 || height < 0 )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->renderRegion( x, y, width, height );
+}
+
+void sglRayTraceDirty(void)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	cc->renderSceneDirty();
+}
+
+int sglBakeLighting(void)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return 0;
+	}
+
+	return cc->bakeLighting();
+}
+
+void sglAttachScene(int id)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() || cc->isDefiningScene() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( id < 0 || static_cast<uint32>( id ) >= cm.contextSize() || !cm.context( id ) )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->attachScene( cm.context( id ) );
+}
+
+void sglRayTraceViews(const float* mvpMatrices, int count, int* contextIds)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( count < 0 || ( count && ( !mvpMatrices || !contextIds ) ) )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	std::vector<matrix4x4> mvps( count );
+	std::vector<Context*> targets( count );
+
+	for ( int i = 0; i < count; ++i )
+	{
+		if ( contextIds[i] < 0 || static_cast<uint32>( contextIds[i] ) >= cm.contextSize() || !cm.context( contextIds[i] ) )
+		{
+			setErrCode( SGL_INVALID_VALUE );
+			return;
+		}
+
+		// column-major like sglMultMatrix
+		for ( uint32 row = 0; row < 4; ++row )
+			for ( uint32 column = 0; column < 4; ++column )
+				mvps[i][row * 4 + column] = mvpMatrices[16 * i + column * 4 + row];
+
+		targets[i] = cm.context( contextIds[i] );
+
+		// two views would race on one color buffer
+		if ( std::find( targets.begin(), targets.begin() + i, targets[i] ) != targets.begin() + i )
+		{
+			setErrCode( SGL_INVALID_VALUE );
+			return;
+		}
+	}
+
+	if ( count )
+		cc->renderViews( &mvps[0], count, &targets[0] );
+}
+
+void sglIntersectRays(const float* origins, const float* dirs, int n, float* tOut, int* primOut)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( n < 0 || ( n && ( !origins || !dirs ) ) )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->intersectRays( origins, dirs, static_cast<uint32>(n), tOut, primOut );
+}
+
+void sglOccludeRays(const float* origins, const float* dirs, const float* tMax, int n, int* occludedOut)
+{
+	Context* cc = cm.currentContext();
+	if ( cc->isInCycle() )
+	{
+		setErrCode( SGL_INVALID_OPERATION );
+		return;
+	}
+
+	if ( n < 0 || ( n && ( !origins || !dirs || !occludedOut ) ) )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	cc->occludeRays( origins, dirs, tMax, static_cast<uint32>(n), occludedOut );
+}
+
+void sglGetRenderStats(sglRenderStats* stats)
+{
+	if ( !stats )
+	{
+		setErrCode( SGL_INVALID_VALUE );
+		return;
+	}
+
+	*stats = cm.currentContext()->getRenderStats();
+}
@@ -84,7 +84,70 @@ enum sglEAreaMode {
 /// Enum for sglEnable() / sglDisable()
 enum sglEEnableFlags {
   /// enable/disable depth test
-  SGL_DEPTH_TEST = 1
+  SGL_DEPTH_TEST = 1,
+  /// enable/disable the irradiance cache for area light shading
+  SGL_IRRADIANCE_CACHE,
+  /// enable/disable sharing of point light shadow rays between neighbouring pixels
+  SGL_SHADOW_SHARING,
+  /// enable/disable the conservative block classification of SGL_SHADOW_SHARING
+  SGL_CONSERVATIVE_SHADOWS,
+  /// switch shading between exact and approximate math
+  SGL_FAST_SHADING,
+  /// enable/disable the edge-aware denoiser run after sglRayTraceScene()
+  SGL_DENOISE,
+  /// enable/disable rendering at a resolution picked from the frame time
+  SGL_DYNAMIC_RESOLUTION,
+  /// enable/disable the reuse of pixels of the previous frame
+  SGL_TEMPORAL_REUSE,
+  /// enable/disable recording of the hits for sglRelightScene()
+  SGL_RELIGHT_CACHE,
+  /// enable/disable reuse of recently ray traced images
+  SGL_FRAME_CACHE,
+  /// enable/disable rasterization of the primary visibility
+  SGL_HYBRID_RENDER,
+  /// enable/disable shadow maps in sglRasterizeScene()
+  SGL_SHADOW_MAPS,
+  /// enable/disable the diffuse light baked by sglBakeLighting()
+  SGL_BAKED_LIGHTING
+};
+
+/// Stages of sglRayTraceSceneWithin(), in the order they are rendered
+enum sglERenderStages {
+  /// primary rays and direct light of every pixel
+  SGL_STAGE_PRIMARY = 1,
+  /// reflected and refracted rays
+  SGL_STAGE_SECONDARY = 2,
+  /// area light samples beyond the first few
+  SGL_STAGE_AREA_SAMPLES = 4
+};
+
+/// Statistics of the last render, returned by sglGetRenderStats()
+struct sglRenderStats {
+  /// Shadow rays answered by the per-light cache of recent occluders
+  unsigned int occluderCacheHits;
+  /// Shadow rays which missed the occluder cache and found another occluder in the scene
+  unsigned int occluderCacheMisses;
+  /// Shadow rays which tested the occluder cache and reached their light
+  unsigned int unoccludedShadowRays;
+  /// Resolution scale of SGL_DYNAMIC_RESOLUTION, 1 when it's disabled
+  float resolutionScale;
+  /// Pixels SGL_DYNAMIC_RESOLUTION traced because no scaled sample matched them
+  unsigned int upscaleTracedPixels;
+  /// Pixels SGL_TEMPORAL_REUSE took from the previous frame instead of shading
+  unsigned int temporalReusedPixels;
+  /// 1 when SGL_FRAME_CACHE copied the image instead of rendering it
+  unsigned int frameCacheHit;
+  /// Pixels traced by the last sglRayTraceScene(), sglRayTraceRegion() or sglRayTraceDirty()
+  unsigned int regionTracedPixels;
+  /// Pixels whose primary hit SGL_HYBRID_RENDER took from the rasterized visibility buffer
+  unsigned int rasterizedPixels;
+  /// Cube shadow maps SGL_SHADOW_MAPS rendered for the last sglRasterizeScene(), the others were cached
+  unsigned int shadowMapsRendered;
+  /// Primitive clusters the rasterization of the last render skipped as off the view, summed over
+  /// the visibility buffer and the shadow map faces
+  unsigned int culledClusters;
+  /// Primitives skipped as off the view, those of the culled clusters included
+  unsigned int culledPrimitives;
 };
 
 //---------------------------------------------------------------------------
@@ -567,6 +630,62 @@ void sglPointSize(float size);
 /**
  @param cap:  
    SGL_DEPTH_TEST ... depth test is off by default
+   SGL_IRRADIANCE_CACHE ... diffuse area light shading is interpolated from
+     sparse cached samples, which are reused across pixels and renders until
+     the scene or its lights change. Off by default.
+   SGL_SHADOW_SHARING ... point light shadow rays are traced for a sparse
+     pixel lattice first, blocks whose corners hit the same primitive and agree
+     on the visibility of a light reuse it, only blocks along shadow boundaries
+     trace their own shadow rays. Off by default.
+   SGL_CONSERVATIVE_SHADOWS ... SGL_SHADOW_SHARING uses a denser lattice and
+     shadowed blocks must be occluded by the same primitive, for renders where
+     missing small shadow features is not acceptable. Off by default.
+   SGL_FAST_SHADING ... Phong highlights use exponentiation by squaring for
+     integer exponents and an exp2/log2 approximation (relative error below
+     shine * 6.5e-6 + 1.8e-7) for the others instead of pow(). Off by default, so that
+     reference renders stay exact.
+   SGL_DENOISE ... sglRayTraceScene() records the normal, depth, albedo and
+     primitive seen through every pixel and filters the image with an
+     edge-aware a-trous wavelet filter guided by them. Meant for renders with
+     few area light samples, see sglAreaLightSamples(). Off by default.
+   SGL_DYNAMIC_RESOLUTION ... sglRayTraceScene() shades a scaled down image,
+     whose scale follows the time of the previous frame and the target set by
+     sglFrameTimeTarget(). The image is upscaled to the full color buffer
+     guided by the primitive visible in every full resolution pixel, so object
+     edges stay sharp. The scale is reported by sglGetRenderStats(). Not
+     combined with SGL_SHADOW_SHARING and SGL_DENOISE. Off by default.
+   SGL_TEMPORAL_REUSE ... sglRayTraceScene() reprojects the pixels of the
+     previous frame to the current camera. A pixel whose primary ray hits the
+     same primitive at the reprojected position reuses the color, for up to 8
+     frames, only the other pixels are shaded. Highlights and reflections lag
+     behind a moving camera accordingly. Any change of the scene or its lights
+     drops the history. Not combined with SGL_DYNAMIC_RESOLUTION,
+     SGL_SHADOW_SHARING and SGL_DENOISE. Off by default.
+   SGL_RELIGHT_CACHE ... sglRayTraceScene() records the hits along the rays of
+     every pixel, so that sglRelightScene() can shade them again after light
+     edits without casting any camera, reflected or refracted rays. Ignored
+     with light sampling, not combined with SGL_DYNAMIC_RESOLUTION,
+     SGL_TEMPORAL_REUSE, SGL_SHADOW_SHARING and SGL_DENOISE. Off by default.
+   SGL_FRAME_CACHE ... sglRayTraceScene() keeps the last 8 images along with a
+     hash of the scene, the lights, the matrices, the viewport and the ray
+     tracing settings, and copies a kept image when all of them match instead
+     of rendering. Not used with SGL_DYNAMIC_RESOLUTION and SGL_TEMPORAL_REUSE,
+     whose images depend on the previous frames. Off by default.
+   SGL_HYBRID_RENDER ... sglRayTraceScene() rasterizes the scene into a buffer
+     of the visible primitive and depth first. Pixels inside a primitive only
+     intersect their ray with it, pixels on primitive edges cast their rays
+     against the whole scene. Shadows, reflections and refractions are ray
+     traced as usual. Objects thinner than a pixel may be missed. Leaves the
+     depth of the visible surfaces in the depth buffer. Not combined with
+     SGL_SHADOW_SHARING. Off by default.
+   SGL_SHADOW_MAPS ... sglRasterizeScene() shadows the lights by cube shadow
+     maps rendered by the rasterizer, one per point light and a few spread over
+     the patch of every area light, which gives it soft shadows. The maps are
+     kept until the geometry changes or their light moves. Off by default.
+   SGL_BAKED_LIGHTING ... sglRayTraceScene() and sglRasterizeScene() read the
+     diffuse light of the triangles baked by sglBakeLighting() instead of
+     evaluating the lights. Triangles with a Phong highlight still shade point
+     lights per hit. Off by default.
 
  ERRORS: 
   - SGL_INVALID_ENUM 
@@ -581,6 +700,18 @@ void sglEnable(sglEEnableFlags cap);
 /**
  @param cap:  
    SGL_DEPTH_TEST
+   SGL_IRRADIANCE_CACHE
+   SGL_SHADOW_SHARING
+   SGL_CONSERVATIVE_SHADOWS
+   SGL_FAST_SHADING
+   SGL_DENOISE
+   SGL_DYNAMIC_RESOLUTION
+   SGL_TEMPORAL_REUSE
+   SGL_RELIGHT_CACHE
+   SGL_FRAME_CACHE
+   SGL_HYBRID_RENDER
+   SGL_SHADOW_MAPS
+   SGL_BAKED_LIGHTING
 
  ERRORS: 
   - SGL_INVALID_ENUM 
@@ -608,6 +739,9 @@ void sglBeginScene();
 
 /// Ends a definition of the scene.
 /**
+ Groups the primitives into clusters with a bounding sphere, so that
+ sglRasterizeScene() and SGL_HYBRID_RENDER skip the clusters off the view.
+
  ERRORS: 
   - SGL_INVALID_OPERATION
     No context has been allocated yet or sglEndScene is called between a 
@@ -703,9 +837,19 @@ the actual task being implemented.
 */
 void sglRayTraceScene();
 
-/// Compute an image using ray tracing
+/// Compute an image using rasterization
 /** 
-Compute an image using rasterization.
+Compute an image using rasterization. A fast preview of the scene for
+interactive use: triangles and spheres are depth tested through the depth
+buffer and the visible surface of every pixel is Phong shaded by the point
+lights, area lights count as a single point at the center of their patch.
+Reflections and refractions are left out, shadows too unless SGL_SHADOW_MAPS
+is enabled. The depth buffer is left with the depth of the scene.
+
+  ERRORS:
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRasterizeScene is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
 */
 void sglRasterizeScene();
 
@@ -744,6 +888,8 @@ void sglEmissiveMaterial(
 /// Set the HDR environment map defining the "background"
 /**
    If defined the environment map replaces the background color (set with sglClearColor) for both primary as well as secondary rays.
+   The texels are read from the given array while rendering; SGL_FRAME_CACHE
+   only notices changed texels when sglEnvironmentMap is called again.
 */
 /**
    @param width [in] texture width.
@@ -759,6 +905,371 @@ void sglEnvironmentMap(const int width,
 					   const int height,
 					   float *texels);
 
+//---------------------------------------------------------------------------
+// Ray tracing extensions
+//---------------------------------------------------------------------------
+
+/// Enables stochastic many-light sampling
+/**
+   Instead of evaluating every point and area light at each hit, the ray tracer
+   picks lightsPerHit lights at random. The probability of picking a light is
+   proportional to its power (the area light patches weighted by their area),
+   the distribution is built once per change of the lights and only the picked
+   lights are shaded, so the cost of a hit grows only with the logarithm of
+   the number of lights. The result is reweighted by the probability. The
+   image is noisier, which is meant to be averaged out over several renders.
+   Passing 0 restores the deterministic evaluation of all lights (default).
+*/
+/**
+   @param lightsPerHit [in] number of lights evaluated per hit.
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     lightsPerHit is negative.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglLightSampling is called between a 
+     call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglLightSampling(const int lightsPerHit);
+
+/// Sets the number of shadow rays per area light and hit
+/**
+   Soft shadows of area lights are estimated with this many samples of the
+   light (16 by default). Renders with 2-4 samples are noisy, but much cheaper,
+   and can be cleaned up by SGL_DENOISE.
+*/
+/**
+   @param samples [in] samples per area light.
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     samples is less than 1.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglAreaLightSamples is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglAreaLightSamples(const int samples);
+
+/// Ray traces the scene within a time budget
+/**
+   Renders in the order of importance: a coarse pass over every 4th pixel
+   first, then primary rays and direct light of every pixel with 4 area light
+   samples, then reflected and refracted rays and finally the remaining area
+   light samples (see sglAreaLightSamples()). The deadline is checked after
+   every row of pixels. When the budget runs out the render stops, pixels the
+   unfinished stage didn't reach keep the result of the previous stage, so the
+   color buffer always holds a complete image.
+
+   The coarse pass always runs to completion, so very small budgets may be
+   exceeded by its duration.
+*/
+/**
+   @param milliseconds [in] time budget.
+   @return bit mask of sglERenderStages which were skipped or not finished,
+     0 when the image is the same as with sglRayTraceScene().
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     milliseconds is negative.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRayTraceSceneWithin is called
+     between a call to sglBegin() and the corresponding call to sglEnd().
+*/
+unsigned int sglRayTraceSceneWithin(const float milliseconds);
+
+/// Sets the frame time SGL_DYNAMIC_RESOLUTION aims for
+/**
+   After every frame the resolution scale is adjusted by the square root of
+   the ratio of the target and the measured frame time, between 0.25 and 1.
+   Without a target (0, the default) the scale stays at 1.
+*/
+/**
+   @param milliseconds [in] target frame time.
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     milliseconds is negative.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglFrameTimeTarget is called
+     between a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglFrameTimeTarget(const float milliseconds);
+
+/// Renders the next level of the coarse-to-fine preview
+/**
+   The first call traces every 8th pixel of every row and column and fills
+   the blocks between them. Every following call halves the spacing (4, 2 and
+   1 pixel), reusing the samples traced so far. Samples inside blocks whose
+   corners hit the same primitive with similar colors are interpolated instead
+   of traced. The color buffer holds a complete image after every call, so an
+   interactive application can display it while the camera stands still and
+   call sglRayTracePreviewReset() when it moves.
+*/
+/**
+   @return spacing of the samples of the rendered level (8, 4, 2 or 1), 0 when
+     the preview is already complete.
+
+  ERRORS:
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRayTracePreviewStep is called
+     between a call to sglBegin() and the corresponding call to sglEnd().
+*/
+int sglRayTracePreviewStep(void);
+
+/// Starts the preview over, the next step renders the coarsest level
+/**
+  ERRORS:
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRayTracePreviewReset is called
+     between a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglRayTracePreviewReset(void);
+
+/// Called by sglRayTracePreview() after every level
+/**
+   @param blockSize [in] spacing of the samples of the finished level.
+   @param userData [in] pointer given to sglRayTracePreview().
+   @return 0 to continue with the next level, anything else stops the preview.
+*/
+typedef int (*sglPreviewCallback)(int blockSize, void *userData);
+
+/// Renders all the levels of the preview, see sglRayTracePreviewStep()
+/**
+   Starts over from the coarsest level and calls the callback after every
+   level, so that it can display the intermediate image.
+*/
+/**
+   @param callback [in] called after every level, may be NULL.
+   @param userData [in] passed to the callback.
+
+  ERRORS:
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRayTracePreview is called
+     between a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglRayTracePreview(sglPreviewCallback callback, void *userData);
+
+/// Moves and recolors a point light of the scene
+/**
+   Unlike other scene changes, point light edits keep the hits recorded for
+   sglRelightScene().
+*/
+/**
+   @param index [in] index of the light, in the order sglPointLight() added them.
+   @param x [in] new position
+   @param y [in] new position
+   @param z [in] new position
+   @param r [in] new color
+   @param g [in] new color
+   @param b [in] new color
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     index is not an index of a point light of the scene.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglSetPointLight is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglSetPointLight(const int index, const float x, const float y, const float z, const float r, const float g, const float b);
+
+/// Replaces the emission of an area light of the scene
+/**
+   The parameters have the meaning of those of sglEmissiveMaterial(). The
+   hits recorded for sglRelightScene() are kept.
+*/
+/**
+   @param index [in] index of the area light, in the order the emissive
+     triangles were added.
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     index is not an index of an area light of the scene.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglSetAreaLightEmission is called
+     between a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglSetAreaLightEmission(const int index, const float r, const float g, const float b, const float c0, const float c1, const float c2);
+
+/// Ray traces the scene after light edits
+/**
+   With SGL_RELIGHT_CACHE enabled, reshades the hits recorded by the last
+   sglRayTraceScene(): a hit costs a shadow ray per point light edited by
+   sglSetPointLight() (two when the light moved), area lights are sampled
+   again only when sglSetAreaLightEmission() was called. Behaves like
+   sglRayTraceScene() when nothing was recorded yet, or the camera, the
+   viewport or any other part of the scene changed.
+
+  ERRORS:
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRelightScene is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglRelightScene(void);
+
+/// Ray traces a rectangle of the color buffer, the rest is kept
+/**
+   The rectangle is clipped to the color buffer. SGL_DENOISE isn't applied.
+*/
+/**
+   @param x [in] X coord of the bottom left corner
+   @param y [in] Y coord of the bottom left corner
+   @param width [in] width of the rectangle
+   @param height [in] height of the rectangle
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     Any of the parameters is negative.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRayTraceRegion is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglRayTraceRegion(const int x, const int y, const int width, const int height);
+
+/// Ray traces the parts of the image changed by light edits
+/**
+   Re-traces only the 16x16 pixel tiles which sglSetPointLight() and
+   sglSetAreaLightEmission() could have changed since the last
+   sglRayTraceScene() or sglRayTraceDirty(): the tiles covered by the screen
+   bounds of the primitives an edited light can reach (before or after the
+   edit), of all the reflective and transmissive primitives and of an edited
+   area light itself. Behaves like sglRayTraceScene() when the camera, the
+   viewport or the geometry changed, or the color buffer holds a preview or
+   a sglRayTraceSceneWithin() image. SGL_DENOISE isn't applied.
+
+  ERRORS:
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRayTraceDirty is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglRayTraceDirty(void);
+
+/// Bakes the diffuse light of the scene triangles for SGL_BAKED_LIGHTING
+/**
+   Stores the irradiance of the point and area lights, with their shadows,
+   over every triangle of the scene, more densely on larger triangles. Area
+   lights get many more samples than sglAreaLightSamples(). Spheres and
+   emissive triangles aren't baked. Only the triangles whose light changed
+   since the previous bake are baked again: those an added or edited light
+   can reach, and those lit through the bounds of an added primitive.
+
+   @return number of triangles baked
+
+  ERRORS:
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglBakeLighting is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+int sglBakeLighting(void);
+
+/// Makes the current context share the scene of another context
+/**
+   The current context renders the primitives and lights of the context id
+   from now on, it keeps its own camera, viewport, enabled modes and
+   environment map. The scene is stored once: its culling clusters,
+   lightmaps and irradiance cache are built once for all the contexts
+   sharing it, and whatever is added or edited through one of them is seen
+   by all. The previous scene of the current context is freed when no other
+   context shares it, a scene lives until its last context is destroyed.
+
+   @param id [in] context whose scene is attached
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     id is not a valid context.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglAttachScene is called between
+     a call to sglBegin() and the corresponding call to sglEnd(), or between
+     sglBeginScene() and sglEndScene().
+*/
+void sglAttachScene(int id);
+
+/// Ray traces the scene of the current context from several cameras at once
+/**
+   Renders view i through the model-view-projection matrix i into the color
+   buffer of the context contextIds[i], with that context's viewport. The
+   views share the scene of the current context, which is prepared only
+   once, and the tiles of all the views are traced by one pool of threads
+   (serially with SGL_IRRADIANCE_CACHE). The matrices of the target contexts
+   are left as they are. The images match those of sglRayTraceScene() with
+   the image reuse modes and SGL_DENOISE disabled, up to the noise of the
+   area lights and of sglLightSampling(), which doesn't depend on the number
+   of threads.
+
+   @param mvpMatrices [in] count matrices of 16 floats in column-major order
+   @param count [in] number of views
+   @param contextIds [in] distinct contexts receiving the views, may include
+                          the current one
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     count is negative, an array is NULL, a context id is invalid or
+     repeated.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglRayTraceViews is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglRayTraceViews(const float* mvpMatrices, int count, int* contextIds);
+
+/// Finds the closest primitive along each of a batch of rays
+/**
+   For picking, visibility and collision queries against the scene of the
+   current context. Rays only test the primitives of the culling clusters
+   (see sglEndScene()) they pass through and are split among the threads.
+   The directions don't need to be normalized, the distances are measured
+   in their lengths. Triangles are hit from both sides.
+
+   @param origins [in] n origins, x, y, z one after another
+   @param dirs [in] n directions, x, y, z one after another
+   @param n [in] number of rays
+   @param tOut [out] distance of every hit, -1 for a miss; may be NULL
+   @param primOut [out] primitive of every hit, -1 for a miss; may be NULL.
+                        Primitives are numbered from 0 in the order they were
+                        defined, area light patches included.
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     n is negative, or origins or dirs is NULL.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglIntersectRays is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglIntersectRays(const float* origins, const float* dirs, int n, float* tOut, int* primOut);
+
+/// Checks whether each of a batch of rays hits the scene
+/**
+   Like sglIntersectRays(), but stops at the first primitive found.
+
+   @param origins [in] n origins, x, y, z one after another
+   @param dirs [in] n directions, x, y, z one after another
+   @param tMax [in] n distances, in lengths of the directions, beyond which
+                    hits don't count; NULL for unlimited rays
+   @param n [in] number of rays
+   @param occludedOut [out] 1 for every ray which hits a primitive, 0 otherwise
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     n is negative, or origins, dirs or occludedOut is NULL.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet or sglOccludeRays is called between
+     a call to sglBegin() and the corresponding call to sglEnd().
+*/
+void sglOccludeRays(const float* origins, const float* dirs, const float* tMax, int n, int* occludedOut);
+
+/// Returns statistics of the last ray traced image of the current context
+/**
+   The statistics are reset by every call to sglRayTraceScene().
+*/
+/**
+   @param stats [out] statistics.
+
+  ERRORS:
+  - SGL_INVALID_VALUE
+     stats is NULL.
+  - SGL_INVALID_OPERATION
+     No context has been allocated yet.
+*/
+void sglGetRenderStats(sglRenderStats* stats);
+
 
 
 #endif /* of _SGL_H_ */